@@ -0,0 +1,191 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "arena.h"
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#ifdef XIVRP_USE_HUGE_PAGES
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+namespace common {
+
+// Size of the blocks each thread bumps through; anything bigger than a quarter
+// of one gets a block to itself, so it doesn't waste the rest of the current
+const std::size_t block_size = 4 * 1024 * 1024;
+
+// Where the thread is in its current block, and which arena that is from
+struct bump_region {
+  std::uint64_t arena_id{0};
+  char *next{nullptr};
+  char *end{nullptr};
+};
+static thread_local bump_region region;
+
+// Arena ids start at 1, so a thread that hasn't allocated yet has no arena
+static std::atomic<std::uint64_t> next_arena_id{1};
+
+//<editor-fold desc="Huge Pages">
+#ifdef XIVRP_USE_HUGE_PAGES
+#ifdef _WIN32
+// Method to find the size of large pages, turning on the privilege that they
+// need first; or 0 if they can't be used
+static std::size_t huge_page_size() {
+  static const std::size_t size = [] {
+    HANDLE token;
+    if (!OpenProcessToken(GetCurrentProcess(),
+                          TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+      return std::size_t(0);
+
+    TOKEN_PRIVILEGES privileges{};
+    privileges.PrivilegeCount = 1;
+    privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+    bool enabled =
+        LookupPrivilegeValueA(nullptr, "SeLockMemoryPrivilege",
+                              &privileges.Privileges[0].Luid) &&
+        AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr,
+                              nullptr) &&
+        GetLastError() == ERROR_SUCCESS;
+    CloseHandle(token);
+
+    return enabled ? std::size_t(GetLargePageMinimum()) : std::size_t(0);
+  }();
+
+  return size;
+}
+
+static void *take_huge_pages(std::size_t size) {
+  return VirtualAlloc(nullptr, size,
+                      MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                      PAGE_READWRITE);
+}
+
+static void free_huge_pages(void *data, std::size_t) {
+  VirtualFree(data, 0, MEM_RELEASE);
+}
+#else
+// Method to find the size of huge pages, being the usual 2 MiB
+static std::size_t huge_page_size() { return 2 * 1024 * 1024; }
+
+static void *take_huge_pages(std::size_t size) {
+  // Explicit huge pages, if any were set aside
+#ifdef MAP_HUGETLB
+  void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (data != MAP_FAILED)
+    return data;
+#endif
+
+  // Otherwise ordinary pages, which the kernel is asked to back with
+  // transparent huge pages
+  void *pages = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (pages == MAP_FAILED)
+    return nullptr;
+#ifdef MADV_HUGEPAGE
+  madvise(pages, size, MADV_HUGEPAGE);
+#endif
+
+  return pages;
+}
+
+static void free_huge_pages(void *data, std::size_t size) {
+  munmap(data, size);
+}
+#endif
+#endif
+//</editor-fold>
+
+arena::arena() { this->id = next_arena_id++; }
+
+arena::~arena() {
+  for (auto &block : this->blocks) {
+#ifdef XIVRP_USE_HUGE_PAGES
+    if (block.is_huge) {
+      free_huge_pages(block.data, block.size);
+      continue;
+    }
+#endif
+    std::free(block.data);
+  }
+}
+
+arena::block arena::take_block(std::size_t size) {
+  block taken;
+
+#ifdef XIVRP_USE_HUGE_PAGES
+  // Huge pages only come whole
+  std::size_t page_size = huge_page_size();
+  if (page_size > 0) {
+    std::size_t pages_size = (size + page_size - 1) / page_size * page_size;
+    taken.data = static_cast<char *>(take_huge_pages(pages_size));
+    if (taken.data != nullptr) {
+      taken.size = pages_size;
+      taken.is_huge = true;
+    }
+  }
+#endif
+
+  // Ordinary memory, if huge pages weren't asked for or there are none left
+  if (taken.data == nullptr) {
+    taken.data = static_cast<char *>(std::malloc(size));
+    taken.size = size;
+  }
+  if (taken.data == nullptr)
+    throw std::bad_alloc();
+
+  std::lock_guard<std::mutex> lock(this->blocks_mutex);
+  this->blocks.push_back(taken);
+
+  return taken;
+}
+
+void *arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  // Big allocations get a block of their own, and the thread's current block
+  // carries on being used after
+  if (bytes > block_size / 4) {
+    auto taken = this->take_block(bytes + alignment);
+    void *start = taken.data;
+    std::size_t space = taken.size;
+    return std::align(alignment, bytes, start, space);
+  }
+
+  // A thread's region from an earlier arena is no use to this one
+  if (region.arena_id != this->id)
+    region = {this->id, nullptr, nullptr};
+
+  // Bump along the thread's current block, starting a new one when it's full
+  void *start = region.next;
+  std::size_t space = region.end - region.next;
+  if (start == nullptr ||
+      std::align(alignment, bytes, start, space) == nullptr) {
+    auto taken = this->take_block(block_size);
+    region.next = taken.data;
+    region.end = taken.data + taken.size;
+
+    start = region.next;
+    space = taken.size;
+    std::align(alignment, bytes, start, space);
+  }
+  region.next = static_cast<char *>(start) + bytes;
+
+  return start;
+}
+
+void arena::do_deallocate(void *, std::size_t, std::size_t) {
+  // Everything is freed with the arena
+}
+
+bool arena::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept {
+  return this == &other;
+}
+
+} // namespace common
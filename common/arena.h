@@ -0,0 +1,58 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_ARENA_H
+#define XIVRP_FORMATTER_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace common {
+
+// Monotonic memory for one run of the formatter. Nearly everything allocated
+// while formatting is kept until the output is written, so nothing is freed
+// piece by piece; each thread bumps through large blocks of its own, and the
+// blocks are all freed together with the arena. Built with
+// XIVRP_USE_HUGE_PAGES, the blocks are put on huge pages where the system
+// allows it
+class arena : public std::pmr::memory_resource {
+public:
+  arena();
+  ~arena() override;
+
+  // Arenas own their blocks, so they can not be copied
+  arena(const arena &) = delete;
+  arena &operator=(const arena &) = delete;
+
+private:
+  // A block of memory taken from the system
+  struct block {
+    char *data{nullptr};
+    std::size_t size{0};
+    bool is_huge{false};
+  };
+
+  // Which arena this is, so a thread can tell which arena its block is from
+  std::uint64_t id;
+
+  // Every block taken, shared between the threads
+  std::vector<block> blocks;
+  std::mutex blocks_mutex;
+
+  // Method to take a new block from the system, of at least the given size
+  block take_block(std::size_t size);
+
+  // Memory resource interface, see std::pmr::memory_resource
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void *pointer, std::size_t bytes,
+                     std::size_t alignment) override;
+  [[nodiscard]] bool
+  do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+};
+
+} // namespace common
+
+#endif // XIVRP_FORMATTER_ARENA_H
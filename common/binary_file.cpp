@@ -0,0 +1,70 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "binary_file.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+namespace common {
+
+//<editor-fold desc="Writing">
+void binary_writer::write_text(std::string_view text) {
+  this->write(std::uint32_t(text.size()));
+  this->buffer.append(text);
+}
+
+void binary_writer::write_time(std::chrono::system_clock::time_point time) {
+  this->write(std::int64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               time.time_since_epoch())
+                               .count()));
+}
+
+bool binary_writer::save(const std::string &path) const {
+  std::string temporary_path = path + ".tmp";
+
+  std::ofstream file(temporary_path, std::ios::binary);
+  file.write(this->buffer.data(), std::streamsize(this->buffer.size()));
+  file.close();
+
+  std::error_code error;
+  if (file.fail()) {
+    std::filesystem::remove(temporary_path, error);
+    return false;
+  }
+
+  // If the file can't be replaced, i.e. it's still open somewhere, it's left
+  // as it was
+  std::filesystem::rename(temporary_path, path, error);
+  if (error) {
+    std::filesystem::remove(temporary_path, error);
+    return false;
+  }
+
+  return true;
+}
+//</editor-fold>
+
+//<editor-fold desc="Reading">
+binary_reader::binary_reader(std::string_view data) { this->data = data; }
+
+std::string_view binary_reader::read_text() {
+  auto length = this->read<std::uint32_t>();
+  if (this->failed || this->position + length > this->data.size()) {
+    this->failed = true;
+    return {};
+  }
+
+  std::string_view text = this->data.substr(this->position, length);
+  this->position += length;
+  return text;
+}
+
+std::chrono::system_clock::time_point binary_reader::read_time() {
+  return std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::nanoseconds(this->read<std::int64_t>())));
+}
+//</editor-fold>
+
+} // namespace common
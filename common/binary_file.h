@@ -0,0 +1,75 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_BINARY_FILE_H
+#define XIVRP_FORMATTER_BINARY_FILE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace common {
+
+// Builds up a binary file out of plain values and length-prefixed text, for
+// the files saved next to a log to speed up later runs
+class binary_writer {
+public:
+  // Method to add a plain value onto the file
+  template <typename T> void write(const T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    this->buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  // Method to add text onto the file, prefixed by its length
+  void write_text(std::string_view text);
+
+  // Method to add a time point onto the file
+  void write_time(std::chrono::system_clock::time_point time);
+
+  // Method to save the file, writing it out beside where it goes and then
+  // swapping it in, so a half-written file is never left behind; false if it
+  // couldn't be written or swapped in
+  [[nodiscard]] bool save(const std::string &path) const;
+
+private:
+  std::string buffer;
+};
+
+// Reads values back out of a binary file in the order they were written,
+// failing instead of reading past the end
+class binary_reader {
+public:
+  explicit binary_reader(std::string_view data);
+
+  // Whether anything failed to be read
+  bool failed{false};
+
+  // Method to read a plain value
+  template <typename T> T read() {
+    T value{};
+    if (this->position + sizeof(T) > this->data.size()) {
+      this->failed = true;
+      return value;
+    }
+    std::memcpy(&value, this->data.data() + this->position, sizeof(T));
+    this->position += sizeof(T);
+    return value;
+  }
+
+  // Method to read length-prefixed text, as a view into the file
+  std::string_view read_text();
+
+  // Method to read a time point
+  std::chrono::system_clock::time_point read_time();
+
+private:
+  std::string_view data;
+  std::size_t position{0};
+};
+
+} // namespace common
+
+#endif // XIVRP_FORMATTER_BINARY_FILE_H
@@ -0,0 +1,154 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "decompressing_buffer.h"
+#include "utilities.h"
+
+namespace common {
+
+// How much of the file is read, and decompressed, at a time
+const std::size_t chunk_size = 64 * 1024;
+
+decompressing_buffer::decompressing_buffer(const std::string &path,
+                                           compression type)
+    : file(path, std::ios::binary), compressed(chunk_size),
+      decompressed(chunk_size) {
+  this->type = type;
+  if (!this->file.is_open() || !is_supported(type))
+    return;
+
+  // Set up the decompressor
+  switch (type) {
+#ifdef XIVRP_HAVE_ZLIB
+  case compression::gzip:
+    // 15 for the largest window, +32 to take either gzip or zlib headers
+    this->opened = inflateInit2(&this->gzip_stream, 15 + 32) == Z_OK;
+    break;
+#endif
+#ifdef XIVRP_HAVE_ZSTD
+  case compression::zstd:
+    this->zstd_stream = ZSTD_createDStream();
+    this->opened = this->zstd_stream != nullptr;
+    break;
+#endif
+  default:
+    break;
+  }
+
+  // Nothing has been decompressed yet
+  this->setg(this->decompressed.data(), this->decompressed.data(),
+             this->decompressed.data());
+}
+
+decompressing_buffer::~decompressing_buffer() {
+  if (!this->opened)
+    return;
+
+#ifdef XIVRP_HAVE_ZLIB
+  if (this->type == compression::gzip)
+    inflateEnd(&this->gzip_stream);
+#endif
+#ifdef XIVRP_HAVE_ZSTD
+  if (this->type == compression::zstd)
+    ZSTD_freeDStream(this->zstd_stream);
+#endif
+}
+
+bool decompressing_buffer::is_open() const { return this->opened; }
+
+compression decompressing_buffer::compression_for(const std::string &path) {
+  if (utilities::check_file_format(path, ".json.gz"))
+    return compression::gzip;
+  if (utilities::check_file_format(path, ".json.zst"))
+    return compression::zstd;
+
+  return compression::none;
+}
+
+bool decompressing_buffer::is_supported(compression type) {
+  switch (type) {
+#ifdef XIVRP_HAVE_ZLIB
+  case compression::gzip:
+    return true;
+#endif
+#ifdef XIVRP_HAVE_ZSTD
+  case compression::zstd:
+    return true;
+#endif
+  default:
+    return false;
+  }
+}
+
+bool decompressing_buffer::read_compressed() {
+  this->file.read(this->compressed.data(),
+                  std::streamsize(this->compressed.size()));
+  this->compressed_size = std::size_t(this->file.gcount());
+  this->compressed_position = 0;
+
+  return this->compressed_size > 0;
+}
+
+decompressing_buffer::int_type decompressing_buffer::underflow() {
+  if (this->gptr() < this->egptr())
+    return traits_type::to_int_type(*this->gptr());
+  if (!this->opened || !this->error.empty())
+    return traits_type::eof();
+
+  // Keep decompressing until there's something to read, or the file runs out
+  std::size_t produced = 0;
+  while (produced == 0) {
+    if (this->compressed_position == this->compressed_size &&
+        !this->read_compressed())
+      return traits_type::eof();
+
+#ifdef XIVRP_HAVE_ZLIB
+    if (this->type == compression::gzip) {
+      auto &stream = this->gzip_stream;
+      stream.next_in = reinterpret_cast<Bytef *>(this->compressed.data() +
+                                                 this->compressed_position);
+      stream.avail_in = uInt(this->compressed_size - this->compressed_position);
+      stream.next_out = reinterpret_cast<Bytef *>(this->decompressed.data());
+      stream.avail_out = uInt(this->decompressed.size());
+
+      int result = inflate(&stream, Z_NO_FLUSH);
+      if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+        this->error = stream.msg != nullptr ? stream.msg : "corrupt gzip data";
+        return traits_type::eof();
+      }
+
+      this->compressed_position = this->compressed_size - stream.avail_in;
+      produced = this->decompressed.size() - stream.avail_out;
+
+      // Logs that were appended to may have been compressed in parts, which
+      // follow on one after another
+      if (result == Z_STREAM_END)
+        inflateReset(&stream);
+    }
+#endif
+#ifdef XIVRP_HAVE_ZSTD
+    if (this->type == compression::zstd) {
+      ZSTD_inBuffer input = {this->compressed.data(), this->compressed_size,
+                             this->compressed_position};
+      ZSTD_outBuffer output = {this->decompressed.data(),
+                               this->decompressed.size(), 0};
+
+      auto result = ZSTD_decompressStream(this->zstd_stream, &output, &input);
+      if (ZSTD_isError(result)) {
+        this->error = ZSTD_getErrorName(result);
+        return traits_type::eof();
+      }
+
+      this->compressed_position = input.pos;
+      produced = output.pos;
+    }
+#endif
+  }
+
+  this->setg(this->decompressed.data(), this->decompressed.data(),
+             this->decompressed.data() + produced);
+
+  return traits_type::to_int_type(*this->gptr());
+}
+
+} // namespace common
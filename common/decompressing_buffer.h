@@ -0,0 +1,82 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_DECOMPRESSING_BUFFER_H
+#define XIVRP_FORMATTER_DECOMPRESSING_BUFFER_H
+
+#include <cstddef>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#ifdef XIVRP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef XIVRP_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace common {
+
+// How a file is compressed, going by its extension
+enum compression {
+  none = 0,
+  gzip = 1,
+  zstd = 2,
+};
+
+// Stream buffer that decompresses a file a chunk at a time as it is read, so
+// the whole decompressed file never has to be held at once
+class decompressing_buffer : public std::streambuf {
+public:
+  decompressing_buffer(const std::string &path, compression type);
+  ~decompressing_buffer() override;
+
+  decompressing_buffer(const decompressing_buffer &) = delete;
+  decompressing_buffer &operator=(const decompressing_buffer &) = delete;
+
+  // Whether the file was opened and the decompressor was set up
+  [[nodiscard]] bool is_open() const;
+
+  // The error from the decompressor, if it failed
+  std::string error;
+
+  // Method to find how a file is compressed, by its extension
+  static compression compression_for(const std::string &path);
+
+  // Method to check whether this build can decompress a file compressed that
+  // way
+  static bool is_supported(compression type);
+
+protected:
+  // Method to decompress the next chunk, once the last has all been read
+  int_type underflow() override;
+
+private:
+  // The compressed file, and the chunk of it being decompressed
+  std::ifstream file;
+  std::vector<char> compressed;
+  std::size_t compressed_size{0};
+  std::size_t compressed_position{0};
+
+  // The chunk decompressed from it, that's being read
+  std::vector<char> decompressed;
+
+  compression type;
+  bool opened{false};
+
+  // Method to read the next chunk of the compressed file, false at its end
+  bool read_compressed();
+
+#ifdef XIVRP_HAVE_ZLIB
+  z_stream gzip_stream{};
+#endif
+#ifdef XIVRP_HAVE_ZSTD
+  ZSTD_DStream *zstd_stream{nullptr};
+#endif
+};
+
+} // namespace common
+
+#endif // XIVRP_FORMATTER_DECOMPRESSING_BUFFER_H
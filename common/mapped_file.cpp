@@ -0,0 +1,94 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace common {
+
+#ifdef _WIN32
+mapped_file::mapped_file(const std::string &path) {
+  // Open the file, letting ChatScanner carry on writing to it meanwhile
+  HANDLE file = CreateFileA(
+      path.c_str(), GENERIC_READ,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+      OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return;
+  this->file_handle = file;
+
+  // Empty files can not be mapped
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+    return;
+
+  // Map the whole file, read-only
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr)
+    return;
+  this->mapping_handle = mapping;
+
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr)
+    return;
+
+  this->data = static_cast<const char *>(view);
+  this->size = std::size_t(file_size.QuadPart);
+}
+
+mapped_file::~mapped_file() {
+  if (this->data != nullptr)
+    UnmapViewOfFile(this->data);
+  if (this->mapping_handle != nullptr)
+    CloseHandle(this->mapping_handle);
+  if (this->file_handle != nullptr)
+    CloseHandle(this->file_handle);
+}
+#else
+mapped_file::mapped_file(const std::string &path) {
+  // Open the file
+  int descriptor = open(path.c_str(), O_RDONLY);
+  if (descriptor == -1)
+    return;
+
+  // Empty files can not be mapped
+  struct stat file_status {};
+  if (fstat(descriptor, &file_status) == -1 || file_status.st_size == 0) {
+    close(descriptor);
+    return;
+  }
+
+  // Map the whole file, read-only; the mapping outlives the descriptor
+  void *view = mmap(nullptr, std::size_t(file_status.st_size), PROT_READ,
+                    MAP_PRIVATE, descriptor, 0);
+  close(descriptor);
+  if (view == MAP_FAILED)
+    return;
+
+  // The log is read front to back
+  madvise(view, std::size_t(file_status.st_size), MADV_SEQUENTIAL);
+
+  this->data = static_cast<const char *>(view);
+  this->size = std::size_t(file_status.st_size);
+}
+
+mapped_file::~mapped_file() {
+  if (this->data != nullptr)
+    munmap(const_cast<char *>(this->data), this->size);
+}
+#endif
+
+bool mapped_file::is_open() const { return this->data != nullptr; }
+
+std::string_view mapped_file::contents() const { return {this->data, this->size}; }
+
+} // namespace common
@@ -0,0 +1,41 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_MAPPED_FILE_H
+#define XIVRP_FORMATTER_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace common {
+
+// A read-only memory mapping of a whole file, unmapped when destroyed
+class mapped_file {
+public:
+  explicit mapped_file(const std::string &path);
+  ~mapped_file();
+
+  // Mappings are owned, so they can not be copied
+  mapped_file(const mapped_file &) = delete;
+  mapped_file &operator=(const mapped_file &) = delete;
+
+  // Whether the file was mapped
+  [[nodiscard]] bool is_open() const;
+
+  // The contents of the file
+  [[nodiscard]] std::string_view contents() const;
+
+private:
+  const char *data{nullptr};
+  std::size_t size{0};
+
+#ifdef _WIN32
+  void *file_handle{nullptr};
+  void *mapping_handle{nullptr};
+#endif
+};
+
+} // namespace common
+
+#endif // XIVRP_FORMATTER_MAPPED_FILE_H
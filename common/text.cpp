@@ -0,0 +1,490 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "text.h"
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace common {
+
+// Method to find the next backslash from a position, counting the characters
+// passed on the way there; characters being every byte that doesn't continue
+// a multibyte character
+static std::size_t find_next_backslash(std::string_view text,
+                                       std::size_t position,
+                                       std::size_t &characters) {
+#if defined(__AVX2__)
+  const __m256i backslashes = _mm256_set1_epi8('\\');
+  // Continuation bytes are 0x80 - 0xBF, which are the only ones below -64
+  const __m256i continuation_limit = _mm256_set1_epi8(-64);
+  for (; position + 32 <= text.size(); position += 32) {
+    __m256i block = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(text.data() + position));
+    auto found = std::uint32_t(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, backslashes)));
+    auto starts = ~std::uint32_t(_mm256_movemask_epi8(
+        _mm256_cmpgt_epi8(continuation_limit, block)));
+
+    if (found != 0) {
+      int offset = std::countr_zero(found);
+      characters += std::popcount(starts & ((std::uint32_t(1) << offset) - 1));
+      return position + offset;
+    }
+    characters += std::popcount(starts);
+  }
+#elif defined(__SSE2__)
+  const __m128i backslashes = _mm_set1_epi8('\\');
+  // Continuation bytes are 0x80 - 0xBF, which are the only ones below -64
+  const __m128i continuation_limit = _mm_set1_epi8(-64);
+  for (; position + 16 <= text.size(); position += 16) {
+    __m128i block = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(text.data() + position));
+    auto found =
+        std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(block, backslashes)));
+    auto starts = ~std::uint32_t(_mm_movemask_epi8(
+                      _mm_cmplt_epi8(block, continuation_limit))) &
+                  0xFFFF;
+
+    if (found != 0) {
+      int offset = std::countr_zero(found);
+      characters += std::popcount(starts & ((std::uint32_t(1) << offset) - 1));
+      return position + offset;
+    }
+    characters += std::popcount(starts);
+  }
+#endif
+
+  // Whatever is left, one byte at a time
+  for (; position < text.size(); position++) {
+    if (text[position] == '\\')
+      return position;
+    if ((text[position] & 0xC0) != 0x80)
+      characters++;
+  }
+
+  return position;
+}
+
+// Method to find the next character that needs escaping for HTML from a
+// position; a backslash, &, < or >
+static std::size_t find_html_special(std::string_view text,
+                                     std::size_t position) {
+#if defined(__AVX2__)
+  const __m256i backslashes = _mm256_set1_epi8('\\');
+  const __m256i ampersands = _mm256_set1_epi8('&');
+  const __m256i less_thans = _mm256_set1_epi8('<');
+  const __m256i greater_thans = _mm256_set1_epi8('>');
+  for (; position + 32 <= text.size(); position += 32) {
+    __m256i block = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(text.data() + position));
+    __m256i special =
+        _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, backslashes),
+                                        _mm256_cmpeq_epi8(block, ampersands)),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(block, less_thans),
+                                        _mm256_cmpeq_epi8(block, greater_thans)));
+    auto found = std::uint32_t(_mm256_movemask_epi8(special));
+    if (found != 0)
+      return position + std::countr_zero(found);
+  }
+#elif defined(__SSE2__)
+  const __m128i backslashes = _mm_set1_epi8('\\');
+  const __m128i ampersands = _mm_set1_epi8('&');
+  const __m128i less_thans = _mm_set1_epi8('<');
+  const __m128i greater_thans = _mm_set1_epi8('>');
+  for (; position + 16 <= text.size(); position += 16) {
+    __m128i block = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(text.data() + position));
+    __m128i special =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, backslashes),
+                                  _mm_cmpeq_epi8(block, ampersands)),
+                     _mm_or_si128(_mm_cmpeq_epi8(block, less_thans),
+                                  _mm_cmpeq_epi8(block, greater_thans)));
+    auto found = std::uint32_t(_mm_movemask_epi8(special));
+    if (found != 0)
+      return position + std::countr_zero(found);
+  }
+#endif
+
+  // Whatever is left, one byte at a time
+  for (; position < text.size(); position++)
+    if (text[position] == '\\' || text[position] == '&' ||
+        text[position] == '<' || text[position] == '>')
+      return position;
+
+  return position;
+}
+
+// Method to read a \uXXXX escape at a position, false if there isn't one
+static bool read_escape(std::string_view text, std::size_t position,
+                        char32_t &code) {
+  if (position + 6 > text.size() || text[position] != '\\' ||
+      text[position + 1] != 'u')
+    return false;
+
+  code = 0;
+  for (std::size_t i = position + 2; i < position + 6; i++) {
+    char digit = text[i];
+    code <<= 4;
+    if (digit >= '0' && digit <= '9')
+      code |= digit - '0';
+    else if (digit >= 'a' && digit <= 'f')
+      code |= digit - 'a' + 10;
+    else if (digit >= 'A' && digit <= 'F')
+      code |= digit - 'A' + 10;
+    else
+      return false;
+  }
+
+  return true;
+}
+
+// Method to read the character an escape stands for, which takes a second
+// escape for surrogate pairs, returning how long the escapes were; 0 if there
+// isn't an escape. Lone surrogates stand for the replacement character
+static std::size_t read_character(std::string_view text, std::size_t position,
+                                  char32_t &character) {
+  if (!read_escape(text, position, character))
+    return 0;
+
+  if (character >= 0xD800 && character <= 0xDBFF) {
+    char32_t low;
+    if (read_escape(text, position + 6, low) && low >= 0xDC00 &&
+        low <= 0xDFFF) {
+      character = 0x10000 + ((character - 0xD800) << 10) + (low - 0xDC00);
+      return 12;
+    }
+  }
+  if (character >= 0xD800 && character <= 0xDFFF)
+    character = 0xFFFD;
+
+  return 6;
+}
+
+// Method to find how many bytes a character takes in UTF-8
+static std::size_t utf8_size(char32_t character) {
+  if (character < 0x80)
+    return 1;
+  if (character < 0x800)
+    return 2;
+  if (character < 0x10000)
+    return 3;
+  return 4;
+}
+
+std::size_t text::decode_unicode_escapes(std::string_view text,
+                                         std::pmr::string &decoded) {
+  // Decoding never makes the text longer, so it's all written into one buffer
+  decoded.resize(text.size());
+  char *output = decoded.data();
+  std::size_t characters = 0;
+
+  std::size_t position = 0;
+  while (position < text.size()) {
+    // Copy everything up to the next escape in one go
+    std::size_t next = find_next_backslash(text, position, characters);
+    std::memcpy(output, text.data() + position, next - position);
+    output += next - position;
+    position = next;
+    if (position == text.size())
+      break;
+
+    // Write out the escaped character, or the backslash if it's not an escape
+    char32_t character;
+    std::size_t length = read_character(text, position, character);
+    if (length == 0) {
+      *output++ = '\\';
+      position++;
+    } else {
+      switch (utf8_size(character)) {
+      case 1:
+        *output++ = char(character);
+        break;
+      case 2:
+        *output++ = char(0xC0 | (character >> 6));
+        *output++ = char(0x80 | (character & 0x3F));
+        break;
+      case 3:
+        *output++ = char(0xE0 | (character >> 12));
+        *output++ = char(0x80 | ((character >> 6) & 0x3F));
+        *output++ = char(0x80 | (character & 0x3F));
+        break;
+      default:
+        *output++ = char(0xF0 | (character >> 18));
+        *output++ = char(0x80 | ((character >> 12) & 0x3F));
+        *output++ = char(0x80 | ((character >> 6) & 0x3F));
+        *output++ = char(0x80 | (character & 0x3F));
+      }
+      position += length;
+    }
+    characters++;
+  }
+
+  decoded.resize(output - decoded.data());
+  return characters;
+}
+
+std::string text::escape_html(std::string_view text) {
+  std::string html;
+  html.reserve(text.size() + text.size() / 8);
+
+  std::size_t position = 0;
+  while (position < text.size()) {
+    // Copy everything up to the next special character in one go
+    std::size_t next = find_html_special(text, position);
+    html.append(text.data() + position, next - position);
+    position = next;
+    if (position == text.size())
+      break;
+
+    // Escapes become character references, keeping their own hex digits
+    // unless they were a surrogate pair, which becomes the one character
+    if (text[position] == '\\') {
+      char32_t character;
+      std::size_t length = read_character(text, position, character);
+      if (length == 0)
+        html += '\\';
+      else if (length == 6 && character != 0xFFFD) {
+        html += "&#x";
+        html.append(text.data() + position + 2, 4);
+        html += ';';
+      } else {
+        char hex[8];
+        auto end = std::to_chars(hex, hex + sizeof(hex),
+                                 std::uint32_t(character), 16);
+        html += "&#x";
+        html.append(hex, end.ptr);
+        html += ';';
+      }
+      position += length == 0 ? 1 : length;
+      continue;
+    }
+
+    // Everything else found is a character HTML needs escaped
+    if (text[position] == '&')
+      html += "&amp;";
+    else if (text[position] == '<')
+      html += "&lt;";
+    else
+      html += "&gt;";
+    position++;
+  }
+
+  return html;
+}
+
+std::size_t text::find_backslash(std::string_view text) {
+  std::size_t characters = 0;
+  return find_next_backslash(text, 0, characters);
+}
+
+std::size_t text::decoded_size(std::string_view text) {
+  std::size_t size = 0;
+  std::size_t characters = 0;
+
+  std::size_t position = 0;
+  while (position < text.size()) {
+    std::size_t next = find_next_backslash(text, position, characters);
+    size += next - position;
+    position = next;
+    if (position == text.size())
+      break;
+
+    char32_t character;
+    std::size_t length = read_character(text, position, character);
+    size += length == 0 ? 1 : utf8_size(character);
+    position += length == 0 ? 1 : length;
+  }
+
+  return size;
+}
+
+// What kind of character a code point is, for counting words
+enum class word_character { other, cjk, cjk_punctuation };
+
+// Method to find whether a code point is CJK, which is counted a character at a
+// time, or CJK punctuation, which separates words like whitespace does. Hangul
+// isn't included, as Korean puts spaces between its words
+static word_character classify_code_point(char32_t code_point) {
+  if ((code_point >= 0x3000 && code_point <= 0x303F) ||
+      (code_point >= 0xFF01 && code_point <= 0xFF0F) ||
+      (code_point >= 0xFF1A && code_point <= 0xFF20) ||
+      (code_point >= 0xFF3B && code_point <= 0xFF40) ||
+      (code_point >= 0xFF5B && code_point <= 0xFF65))
+    return word_character::cjk_punctuation;
+
+  if ((code_point >= 0x2E80 && code_point <= 0x2FFF) ||
+      (code_point >= 0x3040 && code_point <= 0x9FFF) ||
+      (code_point >= 0xF900 && code_point <= 0xFAFF) ||
+      (code_point >= 0xFF66 && code_point <= 0xFF9F) ||
+      (code_point >= 0x20000 && code_point <= 0x2FFFF))
+    return word_character::cjk;
+
+  return word_character::other;
+}
+
+// Method to count the character at a position, returning the position after it
+static std::size_t scan_character(std::string_view text, std::size_t position,
+                                  text_scan &scan, bool &after_space) {
+  auto byte = static_cast<unsigned char>(text[position]);
+  scan.characters++;
+
+  //<editor-fold desc="ASCII">
+  if (byte < 0x80) {
+    bool is_space = byte == ' ' || (byte >= '\t' && byte <= '\r');
+    if (!is_space && after_space)
+      scan.words++;
+    after_space = is_space;
+
+    if (byte == '~' || byte == '_' || byte == '*' || byte == '/')
+      scan.has_emphatic_marks = true;
+
+    return position + 1;
+  }
+  //</editor-fold>
+
+  //<editor-fold desc="Multibyte">
+  // Find how long the character is from its first byte; anything that can't
+  // start a character is counted as one on its own
+  std::size_t length = 1;
+  char32_t code_point = 0;
+  if (byte >= 0xF0 && byte <= 0xF7) {
+    length = 4;
+    code_point = byte & 0x07;
+  } else if (byte >= 0xE0) {
+    length = 3;
+    code_point = byte & 0x0F;
+  } else if (byte >= 0xC0) {
+    length = 2;
+    code_point = byte & 0x1F;
+  }
+  if (length > 1 && position + length <= text.size())
+    for (std::size_t i = 1; i < length; i++)
+      code_point = (code_point << 6) | (text[position + i] & 0x3F);
+  else
+    length = 1;
+
+  switch (classify_code_point(code_point)) {
+  case word_character::cjk:
+    scan.words++;
+    scan.cjk_characters++;
+    after_space = true;
+    break;
+  case word_character::cjk_punctuation:
+    after_space = true;
+    break;
+  default:
+    if (after_space)
+      scan.words++;
+    after_space = false;
+  }
+
+  return position + length;
+  //</editor-fold>
+}
+
+text_scan text::scan(std::string_view text) {
+  text_scan scan;
+  std::size_t position = 0;
+
+  // Whether the last character was whitespace, which the start of the text
+  // counts as, so a word starts at the next character that isn't
+  bool after_space = true;
+
+  // Blocks that are all ASCII are counted at once, and any others a character
+  // at a time
+#if defined(__AVX2__)
+  const __m256i spaces = _mm256_set1_epi8(' ');
+  // The rest of the whitespace is \t through \r
+  const __m256i below_tab = _mm256_set1_epi8('\t' - 1);
+  const __m256i above_return = _mm256_set1_epi8('\r' + 1);
+  const __m256i tildes = _mm256_set1_epi8('~');
+  const __m256i underscores = _mm256_set1_epi8('_');
+  const __m256i asterisks = _mm256_set1_epi8('*');
+  const __m256i slashes = _mm256_set1_epi8('/');
+  __m256i emphatics = _mm256_setzero_si256();
+  while (position + 32 <= text.size()) {
+    __m256i block = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(text.data() + position));
+    if (_mm256_movemask_epi8(block) != 0) {
+      std::size_t block_end = position + 32;
+      while (position < block_end)
+        position = scan_character(text, position, scan, after_space);
+      continue;
+    }
+
+    __m256i whitespace = _mm256_or_si256(
+        _mm256_cmpeq_epi8(block, spaces),
+        _mm256_and_si256(_mm256_cmpgt_epi8(block, below_tab),
+                         _mm256_cmpgt_epi8(above_return, block)));
+    auto space_mask = std::uint32_t(_mm256_movemask_epi8(whitespace));
+    auto starts =
+        ~space_mask & ((space_mask << 1) | std::uint32_t(after_space));
+    scan.words += std::popcount(starts);
+    scan.characters += 32;
+    after_space = (space_mask >> 31) != 0;
+
+    emphatics = _mm256_or_si256(
+        emphatics,
+        _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, tildes),
+                                        _mm256_cmpeq_epi8(block, underscores)),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(block, asterisks),
+                                        _mm256_cmpeq_epi8(block, slashes))));
+    position += 32;
+  }
+  scan.has_emphatic_marks |= _mm256_movemask_epi8(emphatics) != 0;
+#elif defined(__SSE2__)
+  const __m128i spaces = _mm_set1_epi8(' ');
+  // The rest of the whitespace is \t through \r
+  const __m128i below_tab = _mm_set1_epi8('\t' - 1);
+  const __m128i above_return = _mm_set1_epi8('\r' + 1);
+  const __m128i tildes = _mm_set1_epi8('~');
+  const __m128i underscores = _mm_set1_epi8('_');
+  const __m128i asterisks = _mm_set1_epi8('*');
+  const __m128i slashes = _mm_set1_epi8('/');
+  __m128i emphatics = _mm_setzero_si128();
+  while (position + 16 <= text.size()) {
+    __m128i block = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(text.data() + position));
+    if (_mm_movemask_epi8(block) != 0) {
+      std::size_t block_end = position + 16;
+      while (position < block_end)
+        position = scan_character(text, position, scan, after_space);
+      continue;
+    }
+
+    __m128i whitespace =
+        _mm_or_si128(_mm_cmpeq_epi8(block, spaces),
+                     _mm_and_si128(_mm_cmpgt_epi8(block, below_tab),
+                                   _mm_cmplt_epi8(block, above_return)));
+    auto space_mask = std::uint32_t(_mm_movemask_epi8(whitespace));
+    auto starts = ~space_mask &
+                  ((space_mask << 1) | std::uint32_t(after_space)) & 0xFFFF;
+    scan.words += std::popcount(starts);
+    scan.characters += 16;
+    after_space = (space_mask >> 15) != 0;
+
+    emphatics = _mm_or_si128(
+        emphatics,
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, tildes),
+                                  _mm_cmpeq_epi8(block, underscores)),
+                     _mm_or_si128(_mm_cmpeq_epi8(block, asterisks),
+                                  _mm_cmpeq_epi8(block, slashes))));
+    position += 16;
+  }
+  scan.has_emphatic_marks |= _mm_movemask_epi8(emphatics) != 0;
+#endif
+
+  // Whatever is left, a character at a time
+  while (position < text.size())
+    position = scan_character(text, position, scan, after_space);
+
+  return scan;
+}
+
+} // namespace common
@@ -0,0 +1,59 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_TEXT_H
+#define XIVRP_FORMATTER_TEXT_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace common {
+
+// What one scan over some text found
+struct text_scan {
+  // Number of words, being runs of characters between whitespace; CJK text
+  // isn't split up by spaces, so each CJK character is a word of its own
+  std::size_t words{0};
+
+  // Number of characters, being UTF-8 code points
+  std::size_t characters{0};
+
+  // Number of the words that are CJK characters
+  std::size_t cjk_characters{0};
+
+  // Whether there are any emphatic marks (~ _ * /)
+  bool has_emphatic_marks{false};
+};
+
+// Kernels for message text, i.e. the \uXXXX escapes left in it, which work
+// through the text a block at a time (32 bytes with AVX2, 16 with SSE2, or one
+// at a time otherwise)
+class text {
+public:
+  // Method to decode the escapes into UTF-8, joining surrogate pairs into the
+  // one character they stand for, returning how many characters there are
+  static std::size_t decode_unicode_escapes(std::string_view text,
+                                            std::pmr::string &decoded);
+
+  // Method to find the first backslash in the text, i.e. the first possible
+  // escape, or the size of the text if there isn't one
+  static std::size_t find_backslash(std::string_view text);
+
+  // Method to find how many bytes the text will be once decoded, without
+  // decoding it
+  static std::size_t decoded_size(std::string_view text);
+
+  // Method to make the text safe to put in HTML, escaping &, < and >, and
+  // writing the escapes out as character references, in one pass
+  static std::string escape_html(std::string_view text);
+
+  // Method to count the words and characters in the text and check it for
+  // emphatic marks, in one pass
+  static text_scan scan(std::string_view text);
+};
+
+} // namespace common
+
+#endif // XIVRP_FORMATTER_TEXT_H
@@ -64,9 +64,9 @@ common::utilities::find_files_near(const std::string &path_to_file) {
 //</editor-fold>
 
 //<editor-fold desc="String Utilities">
-std::string common::utilities::select_first_n_words(const std::string &str,
+std::string common::utilities::select_first_n_words(std::string_view str,
                                                     int n) {
-  std::istringstream iss(str);
+  std::istringstream iss{std::string(str)};
   std::vector<std::string> words;
   std::string word;
   while (iss >> word) {
@@ -80,120 +80,106 @@ std::string common::utilities::select_first_n_words(const std::string &str,
 
   return result;
 }
+//</editor-fold>
 
-bool common::utilities::starts_with_any( // NOLINT(*-no-recursion)
-    const std::string &str, const std::list<std::string> &arr) {
-
-  // Check that the string is longer than the array items
-  for (const auto &prefix : arr)
-    if (prefix.size() >= str.size())
-      return false;
+bool common::utilities::check_hex_color(const std::string &color) {
+  // Pattern for a hex_color color, 6 or 3 characters long
+  std::regex hex_color_pattern{"^#([a-fA-F0-9]{6}|[a-fA-F0-9]{3})$"};
 
-  // Early returns, for FILLER items
-  if (str == "FILLER")
-    return false;
+  // Check that the color is a valid hex_color color string
+  bool matches = std::regex_match(color, hex_color_pattern);
+  bool matches_with_hash = std::regex_match("#" + color, hex_color_pattern);
 
-  // Search each element in the array, checking if it is the prefix of the
-  // string
-  bool has_prefix =
-      std::any_of(arr.begin(), arr.end(), [&str](const std::string &prefix) {
-        // Don't even check the string for this prefix if the prefix is longer
-        if (prefix.size() > str.size())
-          return false;
-        // Check if the prefix is the beginning of the string
-        return std::equal(prefix.begin(), prefix.end(), str.begin());
-      });
-
-  if (has_prefix) {
-    // If the string ends with any of the prefixes, return true
-    return true;
-  } else if (str.find(' ') != std::string::npos) {
-    // If the string does not start with any of the prefixes, return the result
-    // of trying again but with no spaces in the string
-    std::string no_space = str;
-    no_space.erase(std::remove(no_space.begin(), no_space.end(), ' '),
-                   no_space.end());
-    return starts_with_any(no_space, arr);
-  } else {
-    // If the string does not end with any of the prefixes, and we already tried
-    // removing the spaces, return false
-    return false;
-  }
+  // Return true if it's a valid hex_color color, or is with a hash sign added
+  return matches || matches_with_hash;
 }
 
-bool common::utilities::ends_with_any( // NOLINT(*-no-recursion)
-    const std::string &str, const std::list<std::string> &arr) {
-
-  // Check that the string is longer than the array items
-  for (const auto &suffix : arr)
-    if (suffix.size() >= str.size())
-      return false;
-
-  // Early returns, for FILLER items
-  if (str == "FILLER")
+// Method to read a fixed number of digits from a timestamp, false if they
+// aren't all there
+static bool read_digits(std::string_view text, std::size_t position,
+                        std::size_t count, int &value) {
+  if (position + count > text.size())
     return false;
 
-  // Search each element in the array, checking if it is the suffix of the
-  // string
-  bool has_suffix =
-      std::any_of(arr.begin(), arr.end(), [&str](const std::string &suffix) {
-        // Don't even check the string for this suffix if the suffix is
-        // longer
-        if (suffix.size() > str.size())
-          return false;
-        // Check if the suffix is the end of the string
-        return std::equal(suffix.rbegin(), suffix.rend(), str.rbegin());
-      });
-
-  if (has_suffix) {
-    // If the string ends with any of the suffixes, return true
-    return true;
-  } else if (str.find(' ') != std::string::npos) {
-    // If the string does not end with any of the suffixes, return the
-    // result of trying again but with no spaces in the string
-    std::string no_space = str;
-    no_space.erase(std::remove(no_space.begin(), no_space.end(), ' '),
-                   no_space.end());
-    return starts_with_any(no_space, arr);
-  } else {
-    // If the string does not end with any of the suffixes, and we already
-    // tried removing the spaces, return false
-    return false;
+  value = 0;
+  for (std::size_t i = position; i < position + count; i++) {
+    if (text[i] < '0' || text[i] > '9')
+      return false;
+    value = value * 10 + (text[i] - '0');
   }
+
+  return true;
 }
 
-int common::utilities::count_words(const std::string &str) {
-  std::stringstream ss(str);
-  std::string word;
-  int numWords = 0;
+// Method to read a ChatScanner timestamp, i.e. 2024-03-01T20:00:26.000000-05:00
+// without any streams or allocations, false if it's shaped any other way
+static bool
+read_fixed_timestamp(std::string_view text,
+                     std::chrono::system_clock::time_point &timePoint) {
+  int year, month, day, hour, minute, second;
+  if (!read_digits(text, 0, 4, year) || text.size() < 19 || text[4] != '-' ||
+      !read_digits(text, 5, 2, month) || text[7] != '-' ||
+      !read_digits(text, 8, 2, day) || text[10] != 'T' ||
+      !read_digits(text, 11, 2, hour) || text[13] != ':' ||
+      !read_digits(text, 14, 2, minute) || text[16] != ':' ||
+      !read_digits(text, 17, 2, second))
+    return false;
 
-  // Count the number of words in the string
-  while (ss >> word) {
-    numWords++;
+  // Fractional seconds, up to nanoseconds
+  std::size_t position = 19;
+  std::chrono::nanoseconds fraction{0};
+  if (position < text.size() && text[position] == '.') {
+    std::size_t digits = 0;
+    long long nanoseconds = 0;
+    for (position++; position < text.size() && text[position] >= '0' &&
+                     text[position] <= '9';
+         position++, digits++)
+      nanoseconds = nanoseconds * 10 + (text[position] - '0');
+    if (digits == 0 || digits > 9)
+      return false;
+    for (; digits < 9; digits++)
+      nanoseconds *= 10;
+    fraction = std::chrono::nanoseconds(nanoseconds);
   }
 
-  // Return the number of words
-  return numWords;
-}
-//</editor-fold>
-
-bool common::utilities::check_hex_color(const std::string &color) {
-  // Pattern for a hex_color color, 6 or 3 characters long
-  std::regex hex_color_pattern{"^#([a-fA-F0-9]{6}|[a-fA-F0-9]{3})$"};
+  // The offset from UTC, which has to end the timestamp
+  int offset_hours, offset_minutes;
+  if (position + 6 != text.size() ||
+      (text[position] != '+' && text[position] != '-') ||
+      !read_digits(text, position + 1, 2, offset_hours) ||
+      text[position + 3] != ':' ||
+      !read_digits(text, position + 4, 2, offset_minutes))
+    return false;
+  auto offset =
+      std::chrono::hours(offset_hours) + std::chrono::minutes(offset_minutes);
+  if (text[position] == '-')
+    offset = -offset;
+
+  // Make sure it's a real date and time
+  date::year_month_day date{date::year{year}, date::month(unsigned(month)),
+                            date::day(unsigned(day))};
+  if (!date.ok() || hour > 23 || minute > 59 || second > 59)
+    return false;
 
-  // Check that the color is a valid hex_color color string
-  bool matches = std::regex_match(color, hex_color_pattern);
-  bool matches_with_hash = std::regex_match("#" + color, hex_color_pattern);
+  timePoint = std::chrono::time_point_cast<
+      std::chrono::system_clock::duration>(
+      date::sys_days{date} + std::chrono::hours(hour) +
+      std::chrono::minutes(minute) + std::chrono::seconds(second) + fraction -
+      offset);
 
-  // Return true if it's a valid hex_color color, or is with a hash sign added
-  return matches || matches_with_hash;
+  return true;
 }
 
 std::chrono::system_clock::time_point
-common::utilities::convert_timestamp(const std::string &dateTimeString) {
-  std::istringstream in{dateTimeString};
+common::utilities::convert_timestamp(std::string_view dateTimeString) {
   std::chrono::system_clock::time_point timePoint;
 
+  // Read the usual ChatScanner layout directly
+  if (read_fixed_timestamp(dateTimeString, timePoint))
+    return timePoint;
+
+  std::istringstream in{std::string(dateTimeString)};
+
   // Parse the datetime string into a time point, based on its formatting
   in >> date::parse("%FT%T%Ez", timePoint);
   // Ignore an error above. It's not real, and only even shows with MinGW.
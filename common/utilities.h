@@ -7,6 +7,7 @@
 #include <chrono>
 #include <list>
 #include <string>
+#include <string_view>
 
 namespace common {
 
@@ -25,21 +26,13 @@ public:
   //</editor-fold>
 
   //<editor-fold desc="String utilities">
-  static std::string select_first_n_words(const std::string &str, int n);
-
-  static bool starts_with_any(const std::string &str,
-                              const std::list<std::string> &arr);
-
-  static bool ends_with_any(const std::string &str,
-                            const std::list<std::string> &arr);
-
-  static int count_words(const std::string &str);
+  static std::string select_first_n_words(std::string_view str, int n);
   //</editor-fold>
 
   static bool check_hex_color(const std::string &color);
 
   static std::chrono::system_clock::time_point
-  convert_timestamp(const std::string &dateTimeString);
+  convert_timestamp(std::string_view dateTimeString);
 };
 
 } // namespace common
@@ -25,15 +25,15 @@ related_images::related_images(const std::string &log_file_location,
   this->images = this->relate_images(image_paths, messages);
 }
 
-std::list<std::string>
+std::pmr::list<std::pmr::string>
 related_images::find_images( // NOLINT(*-convert-member-functions-to-static)
     const std::list<std::string> &files) {
-  std::list<std::string> image_paths;
+  std::pmr::list<std::pmr::string> image_paths;
 
   // Find each image in the list of files
   for (const auto &file : files)
     if (file.ends_with(".png"))
-      image_paths.push_back(file);
+      image_paths.emplace_back(file);
 
   return image_paths;
 }
@@ -41,24 +41,25 @@ related_images::find_images( // NOLINT(*-convert-member-functions-to-static)
 int related_images::get_message_by_time(
     std::chrono::system_clock::time_point time,
     const messages::structure &messages) {
+  const auto &store = messages.messages;
   int last_message_id = -1;
 
   // Iterate over each message, returning the last message's ID once a message
   // is beyond the given time
-  for (const auto &message : messages.messages) {
-    if (message.time >= time)
+  for (std::size_t index = 0; index < store.size(); index++) {
+    if (store.times[index] >= time)
       return last_message_id;
-    last_message_id = message.id;
+    last_message_id = store.ids[index];
   }
 
   return -1;
 }
 
 structured_related_images
-related_images::relate_images(std::list<std::string> images,
+related_images::relate_images(const std::pmr::list<std::pmr::string> &images,
                               const messages::structure &messages) {
-  std::list<related_image> related_images;
-  std::list<int> message_ids_with_images;
+  std::pmr::list<related_image> related_images;
+  std::pmr::list<int> message_ids_with_images;
 
   std::string dateTimeString;
   std::chrono::system_clock::time_point timePoint;
@@ -70,12 +71,12 @@ related_images::relate_images(std::list<std::string> images,
     this->related_images_found++;
 
     //<editor-fold desc="File Metadata">
-    std::smatch match;
+    std::pmr::smatch match;
     timestampFound = false;
 
     // Get the file name
     std::filesystem::path image_path(image);
-    std::string file_name = image_path.filename().string();
+    std::pmr::string file_name(image_path.filename().string());
 
     // Get the timestamp from the file name
     if (std::regex_search(file_name, match, this->timestamp_regex)) {
@@ -121,7 +122,7 @@ related_images::relate_images(std::list<std::string> images,
 
     // If the image starts with as many as 4 digits (manually labeled image)
     if (std::isdigit(file_name[0])) {
-      std::string message_id_string = file_name.substr(0, 1);
+      std::string message_id_string(file_name.substr(0, 1));
 
       // Add the second digit (onward) if it exists
       if (std::isdigit(file_name[1])) {
@@ -167,11 +168,11 @@ related_images::relate_images(std::list<std::string> images,
       // If the image date does not fit to a message, use the first message
       // without an image
       if (message_id == -1) {
-        for (const auto &message : messages.messages)
+        for (auto id : messages.messages.ids)
           if (std::find(message_ids_with_images.begin(),
                         message_ids_with_images.end(),
-                        message.id) == message_ids_with_images.end()) {
-            message_id = message.id;
+                        id) == message_ids_with_images.end()) {
+            message_id = id;
             // Count the image as assigned randomly
             this->images_assigned_randomly++;
             break;
@@ -204,15 +205,16 @@ related_images::relate_images(std::list<std::string> images,
     }
   }
 
-  return structured_related_images(related_images);
+  return structured_related_images(std::move(related_images));
 }
 
 structured_related_images::structured_related_images(
-    std::list<related_image> images) {
+    std::pmr::list<related_image> images) {
   this->images = std::move(images);
 }
 
-related_image::related_image(std::string file_path, int related_message_id) {
+related_image::related_image(std::string_view file_path,
+                             int related_message_id) {
   this->related_message_id = related_message_id;
 
   // Get the full path
@@ -227,25 +229,27 @@ related_image::related_image(std::string file_path, int related_message_id) {
   this->encode_image();
 }
 
-std::string related_image::format() {
+std::string related_image::format(bool compact_markup) {
   // Format the image into HTML
-  std::string html = R"(<div class="message_picture"><img alt=")" +
-                     this->file_name + ", " +
-                     std::to_string(this->related_message_id) +
-                     "\" src=\"data:image/png;"
-                     "base64," +
-                     this->encoded_image + "\"/ ></div>";
+  std::string html = R"(<div class="message_picture"><img alt=")";
+  html += this->file_name;
+  html += ", " + std::to_string(this->related_message_id) +
+          "\" src=\"data:image/png;"
+          "base64," +
+          this->encoded_image + "\"/ ></div>";
 
-  // Clear the encoded image
-  this->encoded_image.clear();
+  // Free the encoded image, now it's in the HTML
+  std::string().swap(this->encoded_image);
 
   // Return the HTML
+  if (compact_markup)
+    return html;
   return "<div></div>" + html + "<div></div>";
 }
 
 void related_image::encode_image() {
   // Open the file in binary mode
-  std::ifstream file(this->full_path, std::ios::binary);
+  std::ifstream file(this->full_path.c_str(), std::ios::binary);
 
   // Read the file into a string
   std::string contents((std::istreambuf_iterator<char>(file)),
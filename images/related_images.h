@@ -6,26 +6,30 @@
 
 #include "../messages/messages.h"
 #include <list>
+#include <memory_resource>
 #include <regex>
 #include <string>
+#include <string_view>
 
 namespace related_images {
 
 struct related_image {
 public:
-  related_image(std::string file_path, int related_message_id);
+  related_image(std::string_view file_path, int related_message_id);
 
   // The message ID that the image is related to
   int related_message_id;
 
-  // Method to format the encoded image into HTML
-  std::string format();
+  // Method to format the encoded image into HTML, with or without the spacers
+  // around it
+  std::string format(bool compact_markup);
 
 private:
-  std::string full_path;
-  std::string file_name;
+  std::pmr::string full_path;
+  std::pmr::string file_name;
 
-  // The base64 encoded image
+  // The base64 encoded image. Kept off the arena, since the arena never frees
+  // anything and each image is let go of as soon as it's formatted
   std::string encoded_image;
 
   // Method to encode the image into base64
@@ -34,11 +38,11 @@ private:
 
 struct structured_related_images {
 public:
-  explicit structured_related_images(std::list<related_image> images);
+  explicit structured_related_images(std::pmr::list<related_image> images);
 
   structured_related_images() = default;
 
-  std::list<related_image> images;
+  std::pmr::list<related_image> images;
 };
 
 class related_images {
@@ -61,7 +65,8 @@ public:
 
 private:
   // Method to find the images of the discovered files
-  std::list<std::string> find_images(const std::list<std::string> &files);
+  std::pmr::list<std::pmr::string>
+  find_images(const std::list<std::string> &files);
 
   // Method to get the message before a given a time point
   int get_message_by_time(std::chrono::system_clock::time_point time,
@@ -74,8 +79,9 @@ private:
 
   // Method to relate the images to the messages based on timestamps in the
   // image name
-  structured_related_images relate_images(std::list<std::string> images,
-                                          const messages::structure &messages);
+  structured_related_images
+  relate_images(const std::pmr::list<std::pmr::string> &images,
+                const messages::structure &messages);
 };
 
 } // namespace related_images
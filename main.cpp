@@ -1,14 +1,18 @@
 // XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
 // Licensed under GPLv3 - Refer to the LICENSE file for the complete text
 
+#include "common/arena.h"
 #include "images/related_images.h"
 #include "includes/date.h"
+#include "messages/emphatics.h"
 #include "messages/gaps.h"
 #include "messages/loading.h"
 #include "messages/messages.h"
 #include "settings/settings.h"
 #include "templating/templating.h"
 #include <iostream>
+#include <memory_resource>
+#include <utility>
 #include <windows.h>
 
 using messages::load;
@@ -23,6 +27,11 @@ using settings::structure;
 // 5 : contents not provided to templator
 // 6 : output file could not be created
 int main(int arg_count, char *arguments[]) {
+  // Everything the run allocates is kept until the output is written, so it
+  // all comes from one arena and is freed together at the end
+  common::arena arena;
+  std::pmr::set_default_resource(&arena);
+
   std::cout << "XIVRP-Formatter  Copyright (C) 2024  Ethan Henderson"
             << std::endl
             << std::endl;
@@ -53,20 +62,14 @@ int main(int arg_count, char *arguments[]) {
 
   std::cout << std::endl << "---" << std::endl << std::endl;
 
-  // Load the messages
-  messages::load load(user.settings);
-  // Save the loaded messages
-  messages::structure messages = load.messages;
+  // Load the messages, from the log file already mapped during verification
+  messages::load load(user.settings, user.log_file);
+  // Take the loaded messages over from the loader
+  messages::structure messages = std::move(load.messages);
 
+  // OOC messages were already filtered out while loading, if requested
   int count;
 
-  // Remove OOC messages if requested
-  if (user.settings.remove_out_of_character) {
-    std::cout << std::endl << "Removing OOC messages..." << std::endl;
-    count = messages.remove_ooc();
-    std::cout << "...Removed " << count << " messages." << std::endl;
-  }
-
   if (user.settings.debug)
     messages.debug_print();
 
@@ -80,8 +83,7 @@ int main(int arg_count, char *arguments[]) {
   // Highlight emphatics if requested
   if (user.settings.highlight_emphatics) {
     std::cout << std::endl << "Highlighting emphatics..." << std::endl;
-    count =
-        messages.highlight_emphatics(user.settings.emphatic_highlight_color);
+    count = messages.highlight_emphatics();
     std::cout << "...Highlighted " << count << " messages." << std::endl;
   }
 
@@ -106,7 +108,7 @@ int main(int arg_count, char *arguments[]) {
               << " related randomly." << std::endl;
   }
 
-  // Find and squash time gaps, if requested
+  // Find and squash time gaps in the messages, if requested
   messages::gaps gaps;
   if (user.settings.squash_time_gaps) {
     std::cout << std::endl << "Squashing time gaps..." << std::endl;
@@ -123,22 +125,25 @@ int main(int arg_count, char *arguments[]) {
               << date::format(
                      "%R", floor<std::chrono::milliseconds>(gaps.gap_squashed))
               << " from the session." << std::endl;
-
-    messages = gaps.messages;
   }
 
   // Format the messages
   std::map<std::string, std::string> formatted_messages;
   std::cout << std::endl << "Formatting messages..." << std::endl;
   if (user.settings.find_related_images)
-    formatted_messages = messages.format(related.images);
+    formatted_messages = messages.format(std::move(related.images),
+                                         user.settings.compact_markup);
   else
-    formatted_messages = messages.format();
+    formatted_messages = messages.format(user.settings.compact_markup);
 
   // Fill the template with the messages
   std::cout << "Filling template..." << std::endl;
   templating::templator templator(user.settings.template_file_path);
-  templator.content = formatted_messages;
+  templator.content = std::move(formatted_messages);
+  // Emphatics are colored by one rule in the page's styles
+  if (user.settings.highlight_emphatics)
+    templator.content[templating::STYLES_DATA] =
+        messages::emphatics::stylesheet(user.settings.emphatic_highlight_color);
   templator.fill_template(user.settings.output_file_path);
 
   // Done!
@@ -0,0 +1,24 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "author_table.h"
+
+namespace messages {
+
+int author_table::intern(std::string_view name) {
+  auto existing = this->ids.find(name);
+  if (existing != this->ids.end())
+    return existing->second;
+
+  int id = int(this->names.size());
+  this->names.emplace_back(name);
+  this->ids.emplace(this->names.back(), id);
+
+  return id;
+}
+
+const std::string &author_table::name(int id) const { return this->names[id]; }
+
+int author_table::size() const { return int(this->names.size()); }
+
+} // namespace messages
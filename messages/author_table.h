@@ -0,0 +1,45 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_AUTHOR_TABLE_H
+#define XIVRP_FORMATTER_AUTHOR_TABLE_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace messages {
+
+// Interning table for character names, giving each unique name a dense id in
+// the order it was first seen, so messages only carry the id
+class author_table {
+public:
+  // Method to find the id for a name, adding the name if it's new
+  int intern(std::string_view name);
+
+  // Method to get the name for an id
+  [[nodiscard]] const std::string &name(int id) const;
+
+  // Number of unique names
+  [[nodiscard]] int size() const;
+
+private:
+  // Hash that can look names up without copying them into a string first
+  struct name_hash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view name) const {
+      return std::hash<std::string_view>{}(name);
+    }
+  };
+
+  // Names by id, and ids by name
+  std::vector<std::string> names;
+  std::unordered_map<std::string, int, name_hash, std::equal_to<>> ids;
+};
+
+} // namespace messages
+
+#endif // XIVRP_FORMATTER_AUTHOR_TABLE_H
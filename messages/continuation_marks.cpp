@@ -0,0 +1,122 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "continuation_marks.h"
+#include <vector>
+
+namespace messages {
+
+// One piece of a mark, which can have a space on either side of it
+struct mark_part {
+  // Text the piece is
+  std::string_view literal;
+  // Or, characters the piece is a run of, i.e. the digits of "(1/2)"
+  std::string_view run_of{};
+};
+
+using mark = std::vector<mark_part>;
+
+const std::string_view digits = "0123456789";
+
+//<editor-fold desc="Marks">
+// Marks trimmed off the start of a message, checked in this order
+const std::vector<mark> leading_marks = {
+    {{"."}, {"."}, {"."}},
+    {{".."}},
+    {{"…"}},
+    {{"-"}},
+};
+
+// Marks trimmed off the end of a message, checked in this order
+const std::vector<mark> trailing_marks = {
+    {{"."}, {"."}, {"."}},
+    {{".."}},
+    {{"…"}},
+    {{"-"}},
+    {{">>"}},
+    // "(#/#)", where the total can also be unknown, i.e. "(1/?)"
+    {{"("}, {"", digits}, {"/"}, {"", "?0123456789"}, {")"}},
+};
+//</editor-fold>
+
+//<editor-fold desc="Matching">
+// A space is only ever skipped if it's there, as none of the pieces are spaces
+// themselves, so one scan from either end is enough to match a mark
+
+// Method to find the length of a mark at the start of the text, or 0
+static std::size_t match_leading(std::string_view text, const mark &parts) {
+  std::size_t position = 0;
+
+  for (const auto &part : parts) {
+    if (position < text.size() && text[position] == ' ')
+      position++;
+
+    if (part.run_of.empty()) {
+      if (text.substr(position, part.literal.size()) != part.literal)
+        return 0;
+      position += part.literal.size();
+      continue;
+    }
+
+    std::size_t run_start = position;
+    while (position < text.size() &&
+           part.run_of.find(text[position]) != std::string_view::npos)
+      position++;
+    if (position == run_start)
+      return 0;
+  }
+
+  if (position < text.size() && text[position] == ' ')
+    position++;
+
+  return position;
+}
+
+// Method to find the length of a mark at the end of the text, or 0
+static std::size_t match_trailing(std::string_view text, const mark &parts) {
+  std::size_t position = text.size();
+
+  for (auto part = parts.rbegin(); part != parts.rend(); part++) {
+    if (position > 0 && text[position - 1] == ' ')
+      position--;
+
+    if (part->run_of.empty()) {
+      if (position < part->literal.size() ||
+          text.substr(position - part->literal.size(), part->literal.size()) !=
+              part->literal)
+        return 0;
+      position -= part->literal.size();
+      continue;
+    }
+
+    std::size_t run_end = position;
+    while (position > 0 &&
+           part->run_of.find(text[position - 1]) != std::string_view::npos)
+      position--;
+    if (position == run_end)
+      return 0;
+  }
+
+  if (position > 0 && text[position - 1] == ' ')
+    position--;
+
+  return text.size() - position;
+}
+//</editor-fold>
+
+std::pair<std::size_t, std::size_t>
+continuation_marks::trim(std::string_view text) {
+  std::size_t start = 0;
+  std::size_t end = text.size();
+
+  // Each mark is trimmed at most once, from what the marks before it left
+  for (const auto &mark : leading_marks)
+    start += match_leading(text.substr(start, end - start), mark);
+
+  for (const auto &mark : trailing_marks)
+    end -= match_trailing(text.substr(start, end - start), mark);
+
+  return {start, end};
+}
+
+} // namespace messages
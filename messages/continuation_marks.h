@@ -0,0 +1,26 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_CONTINUATION_MARKS_H
+#define XIVRP_FORMATTER_CONTINUATION_MARKS_H
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+namespace messages {
+
+// Matcher for the marks people put at the ends of messages split across
+// several posts, i.e. "..." or "(1/2)", so they can be trimmed off when the
+// posts are combined back into one message
+class continuation_marks {
+public:
+  // Method to find what is left of the text once the marks at either end, and
+  // the spaces around them, are trimmed off; as the offset of the first
+  // character kept and of the character after the last one kept
+  static std::pair<std::size_t, std::size_t> trim(std::string_view text);
+};
+
+} // namespace messages
+
+#endif // XIVRP_FORMATTER_CONTINUATION_MARKS_H
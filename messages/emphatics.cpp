@@ -0,0 +1,146 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "emphatics.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace messages {
+
+// The marks used to bookend words, in the order they take precedence
+const std::string_view marks = "~_*/";
+
+// What each character of the text is turned into
+enum class token : std::uint8_t {
+  text,
+  // A mark that is replaced with the opening tag
+  opening_mark,
+  // A mark that is replaced with the closing tag
+  closing_mark,
+  // A word that gets the opening tag in front of it
+  word_start
+};
+
+static bool is_word_character(char character) {
+  return (character >= 'a' && character <= 'z') ||
+         (character >= 'A' && character <= 'Z') ||
+         (character >= '0' && character <= '9') || character == '_';
+}
+
+// HTML put around emphasized words
+const std::string_view opening_tag = "<em class=e>";
+const std::string_view closing_tag = "</em>";
+
+std::string emphatics::stylesheet(const std::string &color) {
+  return "<style>em.e { color: " + color + "; font-style: normal; }</style>";
+}
+
+std::pmr::string emphatics::highlight(std::string_view text) {
+  // The tokens are only scratch for this message, so one buffer is reused
+  // rather than each message's being left in the run's arena
+  static thread_local std::vector<token> tokens;
+  tokens.assign(text.size(), token::text);
+  std::size_t spans = 0;
+
+  // Whether a character can be inside an emphasized span; marks already paired
+  // up can't be, as they become tags
+  auto is_span_character = [&](std::size_t position) {
+    return tokens[position] == token::text &&
+           (text[position] == ' ' || is_word_character(text[position]));
+  };
+
+  //<editor-fold desc="Bookended Words">
+  // Each mark pairs up with the next one of the same mark after a run of words
+  // and spaces, leftmost first; earlier marks take precedence over later ones
+  for (char mark : marks) {
+    std::size_t position = 0;
+    while (position < text.size()) {
+      if (text[position] != mark || tokens[position] != token::text) {
+        position++;
+        continue;
+      }
+
+      // Find the end of the run of words and spaces after the mark
+      std::size_t end = position + 1;
+      while (end < text.size() && is_span_character(end))
+        end++;
+
+      // Underscores are word characters, so can be inside the run themselves,
+      // and the last one in it closes the span; other marks have to directly
+      // follow the run
+      std::size_t closing = 0;
+      if (mark == '_') {
+        for (std::size_t search = end - 1; search > position + 1; search--)
+          if (text[search] == '_') {
+            closing = search;
+            break;
+          }
+      } else if (end > position + 1 && end < text.size() &&
+                 text[end] == mark && tokens[end] == token::text)
+        closing = end;
+
+      if (closing == 0) {
+        position++;
+        continue;
+      }
+
+      tokens[position] = token::opening_mark;
+      tokens[closing] = token::closing_mark;
+      spans++;
+      position = closing + 1;
+    }
+  }
+  //</editor-fold>
+
+  //<editor-fold desc="Trailing Tildes">
+  // If there are still tildes used to emphasize individual words, i.e. "word~",
+  // handle those too
+  std::size_t position = 0;
+  while (position < text.size()) {
+    if (text[position] != ' ' || tokens[position] != token::text) {
+      position++;
+      continue;
+    }
+
+    std::size_t end = position + 1;
+    while (end < text.size() && tokens[end] == token::text &&
+           is_word_character(text[end]))
+      end++;
+
+    if (end > position + 1 && end < text.size() && text[end] == '~' &&
+        tokens[end] == token::text) {
+      tokens[position + 1] = token::word_start;
+      tokens[end] = token::closing_mark;
+      spans++;
+      position = end + 1;
+    } else
+      position++;
+  }
+  //</editor-fold>
+
+  // Write the text out with the marks swapped for tags
+  std::pmr::string result;
+  result.reserve(text.size() +
+                 spans * (opening_tag.size() + closing_tag.size()));
+  for (std::size_t index = 0; index < text.size(); index++)
+    switch (tokens[index]) {
+    case token::opening_mark:
+      result += opening_tag;
+      break;
+    case token::closing_mark:
+      result += closing_tag;
+      break;
+    case token::word_start:
+      result += opening_tag;
+      result += text[index];
+      break;
+    default:
+      result += text[index];
+    }
+
+  return result;
+}
+
+} // namespace messages
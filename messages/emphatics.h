@@ -0,0 +1,28 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_EMPHATICS_H
+#define XIVRP_FORMATTER_EMPHATICS_H
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace messages {
+
+// Tokenizer for emphatic marks, i.e. ~this~ or *this*, which finds every
+// emphasized span of a message in one scan and writes the highlighted text out
+// in one go. Emphasized words are marked with a short class, and colored by one
+// rule in the page's styles, instead of each carrying the color
+class emphatics {
+public:
+  // Method to highlight the emphasized words in (already escaped) text
+  static std::pmr::string highlight(std::string_view text);
+
+  // Method to make the styles that color the emphasized words
+  static std::string stylesheet(const std::string &color);
+};
+
+} // namespace messages
+
+#endif // XIVRP_FORMATTER_EMPHATICS_H
@@ -0,0 +1,140 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "filter.h"
+#include "../common/text.h"
+#include "../common/utilities.h"
+#include "message.h"
+#include <memory_resource>
+#include <utility>
+
+namespace messages {
+
+// Shortest message worth keeping, unless the settings say otherwise
+const int default_minimum_length = 10;
+
+filter::filter() { this->add_minimum_length(default_minimum_length); }
+
+// Method to find what a record's marks mean, in its text as it will be printed
+// like messages are classified, only decoding the text if it has escapes
+static std::uint8_t classify_printed(const messages::markers &markers,
+                                     std::string_view body) {
+  if (body.find('\\') == std::string_view::npos)
+    return markers.classify(body);
+
+  // One buffer per thread, reused from record to record
+  static thread_local std::pmr::string printed{
+      std::pmr::new_delete_resource()};
+  common::text::decode_unicode_escapes(body, printed);
+
+  return markers.classify(printed);
+}
+
+filter::filter(const settings::structure &settings) : markers(settings) {
+  //<editor-fold desc="Time Range">
+  if (settings.limit_time_range) {
+    // A blank start or end leaves that end of the range open
+    if (!settings.time_range_start.empty())
+      this->start_time =
+          common::utilities::convert_timestamp(settings.time_range_start);
+    if (!settings.time_range_end.empty())
+      this->end_time =
+          common::utilities::convert_timestamp(settings.time_range_end);
+
+    auto start = this->start_time;
+    auto end = this->end_time;
+    this->checks.emplace_back([start, end](const filter_record &record) {
+      return record.time >= start && record.time <= end;
+    });
+    this->description += "time:" + settings.time_range_start + "-" +
+                         settings.time_range_end + ";";
+  }
+  //</editor-fold>
+
+  //<editor-fold desc="Authors">
+  auto included = split_names(settings.include_authors);
+  if (!included.empty()) {
+    this->checks.emplace_back([included](const filter_record &record) {
+      return included.contains(record.sender_name);
+    });
+    this->description += "include:" + settings.include_authors + ";";
+  }
+
+  auto excluded = split_names(settings.exclude_authors);
+  if (!excluded.empty()) {
+    this->checks.emplace_back([excluded](const filter_record &record) {
+      return !excluded.contains(record.sender_name);
+    });
+    this->description += "exclude:" + settings.exclude_authors + ";";
+  }
+  //</editor-fold>
+
+  //<editor-fold desc="Content">
+  // Out of character messages start with a mark, i.e. a bracket of some kind
+  if (settings.remove_out_of_character) {
+    this->checks.emplace_back(
+        [markers = this->markers](const filter_record &record) {
+          return !(classify_printed(markers, record.body) &
+                   markers::out_of_character);
+        });
+    this->description += "ooc;";
+  }
+
+  this->add_minimum_length(settings.minimum_message_length);
+  //</editor-fold>
+
+  this->description += this->markers.description;
+}
+
+bool filter::keeps(const filter_record &record) const {
+  for (const auto &check : this->checks)
+    if (!check(record))
+      return false;
+
+  return true;
+}
+
+bool filter::within_time_range(
+    std::chrono::system_clock::time_point time) const {
+  return time >= this->start_time && time <= this->end_time;
+}
+
+void filter::add_minimum_length(int minimum_length) {
+  if (minimum_length <= 0)
+    return;
+
+  // Measured as the message will be printed, without building it
+  auto minimum = std::size_t(minimum_length);
+  this->checks.emplace_back([minimum](const filter_record &record) {
+    return record.body.size() >= minimum &&
+           messages::message_body::print_size(record.body) >= minimum;
+  });
+  this->description += "length:" + std::to_string(minimum_length) + ";";
+}
+
+std::set<std::string, std::less<>>
+filter::split_names(const std::string &names) {
+  std::set<std::string, std::less<>> split;
+
+  std::size_t start = 0;
+  while (start <= names.size()) {
+    auto end = names.find(',', start);
+    if (end == std::string::npos)
+      end = names.size();
+
+    // Trim the spaces around the name
+    auto name = std::string_view(names).substr(start, end - start);
+    while (!name.empty() && name.front() == ' ')
+      name.remove_prefix(1);
+    while (!name.empty() && name.back() == ' ')
+      name.remove_suffix(1);
+
+    if (!name.empty())
+      split.emplace(name);
+    start = end + 1;
+  }
+
+  return split;
+}
+
+} // namespace messages
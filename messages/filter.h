@@ -0,0 +1,71 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_FILTER_H
+#define XIVRP_FORMATTER_FILTER_H
+
+#include "../settings/settings.h"
+#include "markers.h"
+#include <chrono>
+#include <functional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace messages {
+
+// A record's fields, as they are before a message is built from them
+struct filter_record {
+public:
+  std::string_view sender_name;
+  std::string_view body;
+  std::chrono::system_clock::time_point time;
+};
+
+// Which records are worth building messages from. Compiled once from the
+// settings into only the checks that are needed, which are then run on each
+// record's raw fields as it is read, so dropped records are never built
+class filter {
+public:
+  // Constructor for the filter that only drops messages too short to keep
+  filter();
+
+  // Constructor, compiling the filter from the settings
+  explicit filter(const settings::structure &settings);
+
+  // Method to check whether a record should become a message
+  [[nodiscard]] bool keeps(const messages::filter_record &record) const;
+
+  // Method to check whether a time is within the time range
+  [[nodiscard]] bool
+  within_time_range(std::chrono::system_clock::time_point time) const;
+
+  // The time range records have to be within
+  std::chrono::system_clock::time_point start_time =
+      std::chrono::system_clock::time_point::min();
+  std::chrono::system_clock::time_point end_time =
+      std::chrono::system_clock::time_point::max();
+
+  // The marks that say what messages are, which out of character messages are
+  // found with here, and which messages are classified with once built
+  messages::markers markers;
+
+  // What the filter checks for, so anything saved with a different filter
+  // isn't reused
+  std::string description;
+
+private:
+  // The checks a record has to pass, cheapest first
+  std::vector<std::function<bool(const messages::filter_record &)>> checks;
+
+  // Method to add the check for messages too short to keep
+  void add_minimum_length(int minimum_length);
+
+  // Method to split a list of names separated by commas
+  static std::set<std::string, std::less<>> split_names(const std::string &names);
+};
+
+} // namespace messages
+
+#endif // XIVRP_FORMATTER_FILTER_H
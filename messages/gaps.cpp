@@ -7,57 +7,33 @@
 
 namespace messages {
 
-gaps::gaps(const structure &messages) {
-  this->messages = messages;
-
-  this->find_average_gap();
-  this->find_gaps();
-  this->assign_gaps_to_messages();
-  this->squash_gap();
-}
-
-bool gaps::find_message_iterator(
-    const message &targetMessage,
-    std::list<messages::message>::iterator &iterator) {
-  // Loop through the messages and find the iterator for the message
-  for (iterator = this->messages.messages.begin();
-       iterator != this->messages.messages.end(); ++iterator)
-    // If this is the message we're checking for
-    if ((*iterator).id == targetMessage.id)
-      return true;
-
-  return false;
+gaps::gaps(structure &messages) {
+  this->find_average_gap(messages);
+  this->find_gaps(messages);
+  this->assign_gaps_to_messages(messages);
+  this->squash_gap(messages);
 }
 
 std::chrono::duration<double>
-gaps::find_gap_from_previous(std::list<message>::iterator &message) {
+gaps::find_gap_from_previous(const structure &messages, std::size_t index) {
   // If this is the first message, return 0
-  if (message == this->messages.messages.begin())
+  if (index == 0)
     return std::chrono::duration<double>(0);
 
-  // Load this message's data
-  auto this_message = *message;
-
-  // Load the previous message's data
-  auto previous_message = *std::prev(message);
-
-  // Find the gap
-  return this_message.time - previous_message.time;
+  // Find the gap from the previous message
+  const auto &times = messages.messages.times;
+  return times[index] - times[index - 1];
 }
 
-void gaps::find_average_gap() {
-  std::list<std::chrono::duration<double>> working_gaps;
+void gaps::find_average_gap(const structure &messages) {
+  std::pmr::vector<std::chrono::duration<double>> working_gaps;
   std::chrono::duration<double> working_average{};
 
   // Loop through the messages and find the average gap
-  for (auto &message : this->messages.messages) {
-    // Find the iterator
-    std::list<messages::message>::iterator message_iterator;
-    this->find_message_iterator(message, message_iterator);
-
+  working_gaps.reserve(messages.messages.size());
+  for (std::size_t index = 0; index < messages.messages.size(); index++)
     // Save the value for averaging
-    working_gaps.emplace_back(this->find_gap_from_previous(message_iterator));
-  }
+    working_gaps.emplace_back(find_gap_from_previous(messages, index));
 
   // Recalculate the working average
   working_average = std::accumulate(working_gaps.begin(), working_gaps.end(),
@@ -71,61 +47,49 @@ void gaps::find_average_gap() {
   this->average_gap /= (double)working_gaps.size();
 }
 
-void gaps::find_gaps() {
+void gaps::find_gaps(const structure &messages) {
   // Loop through the messages and find gaps significantly larger than the
-  // average
-  for (const messages::message &message : this->messages.messages) {
-    // Find the iterator
-    std::list<messages::message>::iterator message_iterator;
-    this->find_message_iterator(message, message_iterator);
-
-    // If this is the first message, skip it
-    if (message_iterator == this->messages.messages.begin())
-      continue;
-
+  // average, skipping the first message
+  for (std::size_t index = 1; index < messages.messages.size(); index++) {
     // Find the gap from the previous message
-    auto gap_duration = this->find_gap_from_previous(message_iterator);
+    auto gap_duration = find_gap_from_previous(messages, index);
 
     // If the gap is more than thrice the average, and it is more than an hour
     if (gap_duration > (this->average_gap * 3) &&
         gap_duration > std::chrono::duration<double>(3600)) {
       // Save the gap
-      this->gaps_found.emplace_back(message.id, gap_duration);
+      this->gaps_found.emplace_back(index, gap_duration);
       this->number_of_gaps_found++;
     }
   }
 }
 
-void gaps::assign_gaps_to_messages() {
+void gaps::assign_gaps_to_messages(structure &messages) {
   // Loop through the gaps and assign them to the messages
-  for (auto &gap : this->gaps_found)
-    for (auto &message : this->messages.messages)
-      // If this is the message we're looking for
-      if (message.id == gap.first) {
-        // Set the gap duration
-        message.gap_duration = gap.second;
-
-        // Set the gap flag
-        message.has_gap_after = true;
-      }
+  for (auto &gap : this->gaps_found) {
+    // Set the gap duration
+    messages.messages.gap_durations[gap.first] = gap.second;
+
+    // Set the gap flag
+    messages.messages.flags[gap.first].has_gap_after = true;
+  }
 }
 
-void gaps::squash_gap() {
+void gaps::squash_gap(structure &messages) {
   // Loop through the gaps and messages, adjusting the time-into-session for
   // each message after the gap
   for (auto &gap : this->gaps_found) {
-    for (auto &message : this->messages.messages)
-      // If this is the message we're looking for, or after it
-      if (message.id >= gap.first) {
-        // Add the average gap to the elapsed time
-        message.elapsed_time += this->average_gap;
-        // Subtract the gap duration from the elapsed time
-        message.elapsed_time -= gap.second;
-
-        // Reformat into_session
-        message.into_session = date::format(
-            "%R", floor<std::chrono::milliseconds>(message.elapsed_time));
-      }
+    // Messages are in time order rather than ID order, so everything from the
+    // gap's message onwards is after it; the time into the session is only
+    // formatted from the elapsed time once the messages are
+    auto &elapsed_times = messages.messages.elapsed_times;
+    for (std::size_t index = gap.first; index < elapsed_times.size();
+         index++) {
+      // Add the average gap to the elapsed time
+      elapsed_times[index] += this->average_gap;
+      // Subtract the gap duration from the elapsed time
+      elapsed_times[index] -= gap.second;
+    }
 
     // Track the total time squashed
     this->gap_squashed += gap.second - this->average_gap;
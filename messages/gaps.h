@@ -4,18 +4,20 @@
 #ifndef XIVRP_FORMATTER_GAPS_H
 #define XIVRP_FORMATTER_GAPS_H
 
-#include "message.h"
 #include "messages.h"
 #include <any>
 #include <chrono>
-#include <list>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
 
 namespace messages {
 
 class gaps {
 public:
-  // Constructor, loading the messages
-  explicit gaps(const messages::structure &messages);
+  // Constructor, finding the gaps in the messages and squashing them, in
+  // place
+  explicit gaps(messages::structure &messages);
   gaps() = default;
 
   // The number of gaps found
@@ -26,33 +28,28 @@ public:
   // Average gap length
   std::chrono::duration<double> average_gap{0};
 
-  // Storing the messages
-  messages::structure messages;
-
 private:
-  // message ID, gap length for gaps found
-  std::list<std::pair<int, std::chrono::duration<double>>> gaps_found;
-
-  // Method to find the iterator for a message
-  bool find_message_iterator(const message &targetMessage,
-                             std::list<messages::message>::iterator &iterator);
+  // message index, gap length for gaps found
+  std::pmr::vector<std::pair<std::size_t, std::chrono::duration<double>>>
+      gaps_found;
 
   // Method to find the gap from the previous message
-  std::chrono::duration<double>
-  find_gap_from_previous(std::list<messages::message>::iterator &message);
+  static std::chrono::duration<double>
+  find_gap_from_previous(const messages::structure &messages,
+                         std::size_t index);
 
   // Method to find the average gap length
-  void find_average_gap();
+  void find_average_gap(const messages::structure &messages);
 
   // Method to loop through the messages and find the gaps
-  void find_gaps();
+  void find_gaps(const messages::structure &messages);
 
   // Method to assign the gaps to the messages
-  void assign_gaps_to_messages();
+  void assign_gaps_to_messages(messages::structure &messages);
 
   // Method to remove the gap from the time-into from all messages after the
   // gap
-  void squash_gap();
+  void squash_gap(messages::structure &messages);
 };
 
 } // namespace messages
@@ -0,0 +1,171 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "ingest.h"
+#include "../common/utilities.h"
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace messages {
+
+// How many records to read between status updates
+const int status_update_frequency = 10000;
+
+ingest::ingest(int records_before) { this->records_before = records_before; }
+
+ingest::ingest(int records_before,
+               std::chrono::system_clock::time_point start_time) {
+  this->records_before = records_before;
+  this->start_time = start_time;
+  this->has_start = true;
+}
+
+//<editor-fold desc="Values">
+// Only string fields are used from records, everything else is skipped past
+bool ingest::null() { return true; }
+
+bool ingest::boolean(bool) { return true; }
+
+bool ingest::number_integer(number_integer_t) { return true; }
+
+bool ingest::number_unsigned(number_unsigned_t) { return true; }
+
+bool ingest::number_float(number_float_t, const string_t &) { return true; }
+
+bool ingest::binary(binary_t &) { return true; }
+
+bool ingest::string(string_t &value) {
+  // Only keep fields that are directly on a record
+  if (this->object_depth != 1)
+    return true;
+
+  if (this->current_key == "SenderName")
+    this->sender_name = std::move(value);
+  else if (this->current_key == "Message")
+    this->message = std::move(value);
+  else if (this->current_key == "DateSent")
+    this->date_sent = std::move(value);
+  else if (this->current_key == "OwnerId")
+    this->owner_id = std::move(value);
+
+  return true;
+}
+//</editor-fold>
+
+//<editor-fold desc="Structure">
+bool ingest::start_object(std::size_t) {
+  this->object_depth++;
+
+  // Clear out the previous record's fields when a new record starts
+  if (this->object_depth == 1) {
+    this->sender_name.clear();
+    this->message.clear();
+    this->date_sent.clear();
+    this->owner_id.clear();
+  }
+
+  return true;
+}
+
+bool ingest::key(string_t &value) {
+  if (this->object_depth == 1)
+    this->current_key = std::move(value);
+
+  return true;
+}
+
+bool ingest::end_object() {
+  // A record was finished
+  if (this->object_depth == 1)
+    this->finish_record();
+
+  this->object_depth--;
+
+  return true;
+}
+
+bool ingest::start_array(std::size_t) { return true; }
+
+bool ingest::end_array() { return true; }
+
+bool ingest::parse_error(std::size_t, const std::string &,
+                         const nlohmann::detail::exception &exception) {
+  this->error = exception.what();
+
+  // Stop parsing
+  return false;
+}
+//</editor-fold>
+
+void ingest::finish_record() {
+  this->add_record(this->sender_name,
+                   messages::message_body(std::move(this->message)),
+                   this->date_sent, this->owner_id);
+}
+
+void ingest::add_record(std::string_view sender_name,
+                        messages::message_body body, std::string_view date_sent,
+                        std::string_view owner_id) {
+  auto time = common::utilities::convert_timestamp(date_sent);
+  this->number_of_records++;
+
+  //<editor-fold desc="Metadata">
+  // The first record sets the owner and start of the log, and the last record
+  // read is the end of the log so far; only counting records within the time
+  // range, if the whole log is being read for one
+  if (this->filter->within_time_range(time)) {
+    if (!this->has_start) {
+      this->owner = owner_id;
+      this->start_time = time;
+      this->has_start = true;
+    }
+    this->end_time = time;
+  }
+
+  // Find the character's id, adding them if they're new
+  int author_id = this->authors.intern(sender_name);
+  //</editor-fold>
+
+  //<editor-fold desc="Status Updates">
+  if (this->print_status_updates &&
+      this->number_of_records % status_update_frequency == 0)
+    std::cout << "......parsed " << this->number_of_records << " messages"
+              << std::endl;
+  //</editor-fold>
+
+  // Only build the message if the filter keeps it
+  if (!this->filter->keeps({sender_name, body.text(), time})) {
+    this->skipped_messages++;
+    return;
+  }
+
+  this->messages.add(this->records_before + this->number_of_records,
+                     author_id, std::move(body), this->start_time, time,
+                     this->filter->markers);
+}
+
+void ingest::merge(messages::ingest &&chunk) {
+  // Find this ingest's id for each of the chunk's names
+  std::vector<int> author_ids;
+  author_ids.reserve(chunk.authors.size());
+  for (int author_id = 0; author_id < chunk.authors.size(); author_id++)
+    author_ids.push_back(this->authors.intern(chunk.authors.name(author_id)));
+
+  // Point the chunk's messages at those ids
+  for (auto &author_id : chunk.messages.author_ids)
+    author_id = author_ids[author_id];
+
+  // Keep whatever the chunk's bodies view into
+  for (const auto &file : chunk.backing->mapped_files)
+    this->backing->keep(file);
+
+  // Add the chunk's messages and metadata onto the end of this ingest's
+  this->messages.append(std::move(chunk.messages));
+  this->number_of_records += chunk.number_of_records;
+  this->skipped_messages += chunk.skipped_messages;
+  if (chunk.number_of_records > 0)
+    this->end_time = chunk.end_time;
+}
+
+} // namespace messages
@@ -0,0 +1,117 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_INGEST_H
+#define XIVRP_FORMATTER_INGEST_H
+
+#include "../includes/json.hpp"
+#include "author_table.h"
+#include "filter.h"
+#include "message_store.h"
+#include "messages.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+
+using json = nlohmann::json;
+
+namespace messages {
+
+// SAX handler for ChatScanner logs, building messages straight from the
+// parser's token stream so the whole log never has to exist as a JSON document.
+// Records can also be added directly, i.e. from the mapped log file
+class ingest : public nlohmann::json_sax<json> {
+public:
+  ingest() = default;
+
+  // Constructor for reading a part of the log on its own, numbering the
+  // messages from where that part starts
+  explicit ingest(int records_before);
+
+  // Constructor for reading a chunk of the log that starts part way through it
+  ingest(int records_before, std::chrono::system_clock::time_point start_time);
+
+  // Method to turn a record's fields into a message
+  void add_record(std::string_view sender_name, messages::message_body body,
+                  std::string_view date_sent, std::string_view owner_id);
+
+  // Method to add the messages from the chunk of the log following this one
+  void merge(messages::ingest &&chunk);
+
+  // Which records to build messages from
+  std::shared_ptr<const messages::filter> filter =
+      std::make_shared<const messages::filter>();
+
+  // Whether to print status updates while reading records
+  bool print_status_updates{false};
+
+  // The messages built so far
+  messages::message_store messages;
+
+  // Metadata about the messages, tracked as the records stream past
+  // Owner of the messages (the first record's owner)
+  std::string owner;
+
+  // Number of records read, including skipped ones
+  int number_of_records{0};
+
+  // Number of records the filter dropped
+  int skipped_messages{0};
+
+  // Unique character names seen, which messages refer to by id
+  messages::author_table authors;
+
+  // What the messages view into
+  std::shared_ptr<messages::backing> backing =
+      std::make_shared<messages::backing>();
+
+  // Time of the first and last records
+  std::chrono::system_clock::time_point start_time;
+  std::chrono::system_clock::time_point end_time;
+
+  // The error from the parser, if it failed
+  std::string error;
+
+  // SAX events, see nlohmann::json_sax
+  bool null() override;
+  bool boolean(bool value) override;
+  bool number_integer(number_integer_t value) override;
+  bool number_unsigned(number_unsigned_t value) override;
+  bool number_float(number_float_t value, const string_t &text) override;
+  bool string(string_t &value) override;
+  bool binary(binary_t &value) override;
+  bool start_object(std::size_t elements) override;
+  bool key(string_t &value) override;
+  bool end_object() override;
+  bool start_array(std::size_t elements) override;
+  bool end_array() override;
+  bool parse_error(std::size_t position, const std::string &last_token,
+                   const nlohmann::detail::exception &exception) override;
+
+private:
+  // Number of records in the log before the ones read here
+  int records_before{0};
+
+  // Whether the owner and start of the log are already known
+  bool has_start{false};
+
+  // How many objects deep the parser is, records are at depth 1
+  int object_depth{0};
+
+  // The last key read on the current record
+  std::string current_key;
+
+  // Fields of the record currently being read
+  std::string sender_name;
+  std::string message;
+  std::string date_sent;
+  std::string owner_id;
+
+  // Method to turn the finished record into a message
+  void finish_record();
+};
+
+} // namespace messages
+
+#endif // XIVRP_FORMATTER_INGEST_H
@@ -3,135 +3,323 @@
 
 #include "loading.h"
 #include "../common/utilities.h"
-#include <chrono>
+#include "session_cache.h"
+#include "time_index.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <thread>
 #include <utility>
+#include <vector>
 
 using json = nlohmann::json;
 
-messages::load::load(const settings::structure &settings) {
+// The fewest records worth giving their own thread
+const std::size_t minimum_records_per_chunk = 4096;
+
+messages::load::load(const settings::structure &settings,
+                     std::shared_ptr<messages::log_file> log_file) {
   std::cout << "Loading messages ..." << std::endl;
 
   // Set the path to the messages log file
   this->messages_log_file = settings.log_file_path;
+  this->log_file = std::move(log_file);
+  this->compression =
+      common::decompressing_buffer::compression_for(this->messages_log_file);
 
-  // Open the messages log file
-  std::stringstream log_file_buffer;
-  std::string log_file_content;
-  std::string line;
-  std::ifstream file;
-  file.open(this->messages_log_file);
+  // Compile the filter deciding which records become messages
+  this->filter = std::make_shared<const messages::filter>(settings);
 
-  // Make sure the log file can be opened
-  if (file.is_open()) {
-    while (std::getline(file, line)) {
-      log_file_buffer << line << '\n';
+  messages::ingest ingest;
+  ingest.filter = this->filter;
+  if (settings.limit_time_range) {
+    // Read only the records within the time range, which isn't worth caching
+    if (!this->load_time_range(ingest))
+      exit(3);
+  } else {
+    // Restore the log from its session cache if it hasn't changed since, or
+    // if following the log, if it was only added onto since
+    messages::session_cache cache(this->messages_log_file);
+    bool restored = cache.load(ingest, settings.follow_log);
+
+    if (restored && !cache.is_partial)
+      std::cout << "...message log restored from the session cache"
+                << std::endl;
+    else if (restored && this->load_appended(ingest, cache.parsed_until))
+      cache.save(ingest, this->parsed_until);
+    else {
+      // Otherwise read it straight out of memory if possible, or stream it
+      ingest = messages::ingest();
+      ingest.filter = this->filter;
+      if (!this->load_mapped(ingest)) {
+        ingest = messages::ingest();
+        ingest.filter = this->filter;
+        this->parsed_until = 0;
+        if (!this->load_streamed(ingest))
+          exit(3);
+      }
+
+      // Save the loaded log for next time
+      if (ingest.number_of_records > 0)
+        cache.save(ingest, this->parsed_until);
     }
-    log_file_content = log_file_buffer.str();
-    file.close();
-    std::cout << "...message log file loaded" << std::endl;
-  } else { // If the file could not be opened, exit
-    std::cout << "Error: Messages log file could not be opened." << std::endl;
-    file.close();
-    exit(3);
   }
 
-  // Parse the file contents into JSON
-  this->messages_log = json::parse(log_file_content);
+  // If the file had nothing in it, exit
+  if (ingest.number_of_records == 0) {
+    std::cout << "Error: Messages log file has no messages in it." << std::endl;
+    exit(3);
+  }
 
   // Print some metadata about the messages log
   std::cout << "...message log file parsed" << std::endl;
-  std::cout << "...found " << this->get_number_of_messages() << " messages"
+  std::cout << "...found " << ingest.number_of_records << " messages"
             << std::endl;
-  std::cout << "...found " << this->get_number_of_participants()
+  std::cout << "...found " << ingest.authors.size()
             << " characters" << std::endl;
-  std::cout << "...found " << this->get_messages_owner() << " as the log owner"
-            << std::endl;
-
-  // Build the message list
-  auto messages_list = get_messages();
-  std::cout << "...messages parsed" << std::endl;
+  std::cout << "...found " << ingest.owner << " as the log owner" << std::endl;
+  std::cout << "......skipped " << ingest.skipped_messages
+            << " filtered messages" << std::endl;
 
   // Build the messages object
   this->messages = messages::structure(
-      this->get_messages_owner(), this->get_number_of_messages(),
-      this->get_number_of_participants(), std::move(messages_list),
-      common::utilities::convert_timestamp(this->messages_log[0]["DateSent"]),
-      common::utilities::convert_timestamp(
-          this->messages_log[this->get_number_of_messages() - 1]["DateSent"]));
+      ingest.owner, ingest.number_of_records, std::move(ingest.authors),
+      std::move(ingest.messages),
+      ingest.start_time, ingest.end_time);
+  this->messages.backing = ingest.backing;
+
+  // Put the messages back in time order, in case the log was written out of
+  // order
+  int out_of_order = this->messages.sort_by_time();
+  if (out_of_order > 0)
+    std::cout << "......put " << out_of_order
+              << " out of order runs of messages back in time order"
+              << std::endl;
 
   std::cout << "...messages built" << std::endl << std::endl;
 }
 
-std::string messages::load::get_messages_owner() {
-  // Return the owner of the messages (the first message's owner)
-  return this->messages_log[0]["OwnerId"];
+bool messages::load::map_log_file() {
+  if (this->compression != common::compression::none)
+    return false;
+
+  if (this->log_file == nullptr)
+    this->log_file =
+        std::make_shared<messages::log_file>(this->messages_log_file, false);
+
+  return this->log_file->is_valid;
+}
+
+bool messages::load::scan_log_file() {
+  if (!this->map_log_file())
+    return false;
+
+  if (!this->log_file->is_scanned)
+    this->log_file->find_records();
+
+  return this->log_file->is_valid;
 }
 
-int messages::load::get_number_of_messages() {
-  // Return the number of messages in the log
-  return (int)this->messages_log.size();
+bool messages::load::load_mapped(messages::ingest &ingest) {
+  if (!this->scan_log_file())
+    return false;
+  std::cout << "...message log file mapped" << std::endl;
+
+  const auto &records = this->log_file->records;
+  if (records.empty())
+    return true;
+  this->parsed_until = records.back().second;
+
+  return this->read_chunked(ingest, 0, records.size());
 }
 
-int messages::load::get_number_of_participants() {
-  std::list<std::string> participants;
-
-  // Loop through the messages and add the character name to the list,
-  // without duplicate entries
-  for (int i = 0; i < this->get_number_of_messages(); i++) {
-    // Get the character name
-    std::string author = this->messages_log[i]["SenderName"];
-    // If the character name is not already in the list, add it
-    if (std::find(participants.begin(), participants.end(), author) ==
-        participants.end()) {
-      participants.push_back(author);
-    }
+bool messages::load::load_time_range(messages::ingest &ingest) {
+  // Logs that can't be mapped, i.e. compressed ones, have to be read in full,
+  // with the filter dropping the records outside the range
+  if (!this->map_log_file())
+    return this->load_streamed(ingest);
+  std::cout << "...message log file mapped" << std::endl;
+
+  // Find which records were sent within the range, and where they are, from
+  // the log's time index; only those records are read
+  messages::time_index index(*this->log_file, this->messages_log_file);
+  if (!this->log_file->is_valid)
+    return this->load_streamed(ingest);
+  auto [first, last] =
+      index.find_range(this->filter->start_time, this->filter->end_time);
+  std::cout << "...found " << last - first << " records within the time range"
+            << std::endl;
+  if (first == last) {
+    std::cout << "Error: No messages were sent within the time range."
+              << std::endl;
+    return false;
   }
 
-  // Return the number of unique character names
-  return (int)participants.size();
+  // Number the messages by where they are in the whole log, but start the
+  // log at the first message in the range
+  ingest = messages::ingest(int(first));
+  ingest.filter = this->filter;
+
+  return this->read_chunked(ingest, first, last);
 }
 
-std::list<messages::message> messages::load::get_messages() {
-  std::list<messages::message> messages;
-  int number_of_messages = this->get_number_of_messages();
-  int skipped_messages = 0;
-
-  // Set the number of status updates
-  int number_of_updates = 5;
-  int frequency = number_of_messages / (number_of_updates - 1);
-
-  int i = 0;
-  for (auto &message : this->messages_log) {
-    //<editor-fold desc="Status Updates">
-    // Check if it's time for a status update
-    if (i % frequency == 0) {
-      std::cout << "......parsing messages " << i
-                << " - "
-                // Check if the next update would be out of bounds
-                << (((i + frequency) > number_of_messages) ? number_of_messages
-                                                           : (i + frequency))
-                << std::endl;
-    }
-    i++;
-    //</editor-fold>
+bool messages::load::read_chunked(messages::ingest &ingest, std::size_t first,
+                                  std::size_t last) {
+  std::size_t number_of_records = last - first;
 
-    auto message_body = messages::message_body(message["Message"]);
+  //<editor-fold desc="Chunking">
+  // Use as many threads as there are cores, if there are enough records
+  std::size_t number_of_chunks =
+      std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  number_of_chunks = std::min(
+      number_of_chunks,
+      std::max<std::size_t>(1, number_of_records / minimum_records_per_chunk));
+  std::size_t chunk_size =
+      (number_of_records + number_of_chunks - 1) / number_of_chunks;
 
-    if (message_body.to_print().size() < 10) {
-      skipped_messages++;
-      continue;
-    }
+  // Every chunk needs the start of the log, which is the first record's time
+  messages::raw_record first_record;
+  if (!this->log_file->read_record(first, first_record))
+    return false;
+  auto start_time = common::utilities::convert_timestamp(
+      raw_record::unescape(first_record.date_sent));
 
-    messages.emplace_back(
-        i, message["SenderName"], message_body,
-        common::utilities::convert_timestamp(this->messages_log[0]["DateSent"]),
-        common::utilities::convert_timestamp(message["DateSent"]));
+  // Set up the chunks, the first of which is the ingest being loaded into
+  std::vector<messages::ingest> chunks;
+  chunks.push_back(std::move(ingest));
+  for (std::size_t i = 1; i < number_of_chunks; i++) {
+    chunks.emplace_back(int(first + i * chunk_size), start_time);
+    chunks.back().filter = this->filter;
   }
+  //</editor-fold>
 
-  std::cout << "......skipped " << skipped_messages << " short messages"
-            << std::endl;
+  //<editor-fold desc="Reading">
+  // Read each chunk on its own thread, with the first on this one
+  std::vector<char> succeeded(number_of_chunks, false);
+  std::vector<std::thread> threads;
+  auto read_chunk = [&](std::size_t chunk) {
+    std::size_t chunk_first = first + chunk * chunk_size;
+    std::size_t chunk_last = std::min(last, chunk_first + chunk_size);
+    succeeded[chunk] =
+        this->read_records(chunks[chunk], chunk_first, chunk_last);
+  };
+  for (std::size_t i = 1; i < number_of_chunks; i++)
+    threads.emplace_back(read_chunk, i);
+  read_chunk(0);
+  for (auto &thread : threads)
+    thread.join();
+
+  if (std::find(succeeded.begin(), succeeded.end(), false) != succeeded.end())
+    return false;
+  //</editor-fold>
+
+  // Stitch the chunks back together, in order
+  for (std::size_t i = 0; i < number_of_chunks; i++) {
+    std::cout << "......parsed messages " << first + i * chunk_size << " - "
+              << std::min(last, first + (i + 1) * chunk_size) << " on thread "
+              << i + 1 << std::endl;
+
+    if (i == 0)
+      ingest = std::move(chunks[0]);
+    else
+      ingest.merge(std::move(chunks[i]));
+  }
+
+  return true;
+}
+
+bool messages::load::load_appended(messages::ingest &ingest,
+                                   std::uint64_t restored_until) {
+  if (!this->map_log_file())
+    return false;
+
+  // Find just the records past what was restored, without scanning the rest
+  // of the log again
+  if (!this->log_file->find_records_after(restored_until))
+    return false;
+  const auto &records = this->log_file->records;
+
+  // Read them, numbered on from the restored ones
+  messages::ingest added(ingest.number_of_records, ingest.start_time);
+  added.filter = this->filter;
+  if (!this->read_records(added, 0, records.size()))
+    return false;
+
+  std::cout << "...restored " << ingest.number_of_records
+            << " messages from the session cache" << std::endl;
+  std::cout << "...read " << added.number_of_records
+            << " messages added to the log since" << std::endl;
+
+  ingest.merge(std::move(added));
+  this->parsed_until = records.empty() ? restored_until : records.back().second;
+
+  return true;
+}
+
+bool messages::load::read_records(messages::ingest &ingest, std::size_t first,
+                                  std::size_t last) {
+  // Keep the mapping alive for as long as the messages viewing into it
+  ingest.backing->keep(this->log_file->file);
+
+  for (std::size_t i = first; i < last; i++) {
+    messages::raw_record fields;
+    if (!this->log_file->read_record(i, fields))
+      return false;
+
+    // Only copy fields that need their escapes undone
+    auto body = raw_record::is_escaped(fields.message)
+                    ? messages::message_body(raw_record::unescape(fields.message))
+                    : messages::message_body::borrow(fields.message);
+
+    if (raw_record::is_escaped(fields.sender_name) ||
+        raw_record::is_escaped(fields.owner_id))
+      ingest.add_record(raw_record::unescape(fields.sender_name),
+                        std::move(body), fields.date_sent,
+                        raw_record::unescape(fields.owner_id));
+    else
+      ingest.add_record(fields.sender_name, std::move(body), fields.date_sent,
+                        fields.owner_id);
+  }
+
+  return true;
+}
+
+bool messages::load::load_streamed(messages::ingest &ingest) {
+  // Open the messages log file, decompressing it as it's read if needed
+  std::unique_ptr<std::streambuf> file;
+  common::decompressing_buffer *decompressing = nullptr;
+  bool opened;
+  if (this->compression == common::compression::none) {
+    auto plain = std::make_unique<std::filebuf>();
+    opened = plain->open(this->messages_log_file,
+                         std::ios::in | std::ios::binary) != nullptr;
+    file = std::move(plain);
+  } else {
+    auto compressed = std::make_unique<common::decompressing_buffer>(
+        this->messages_log_file, this->compression);
+    opened = compressed->is_open();
+    decompressing = compressed.get();
+    file = std::move(compressed);
+  }
+
+  // Make sure the log file can be opened
+  if (!opened) {
+    std::cout << "Error: Messages log file could not be opened." << std::endl;
+    return false;
+  }
+  std::cout << "...message log file opened" << std::endl;
+
+  // Stream the file through the parser, building the messages as it goes
+  ingest.print_status_updates = true;
+  std::istream stream(file.get());
+  bool parsed = json::sax_parse(stream, &ingest);
+
+  if (!parsed)
+    std::cout << "Error: Messages log file could not be parsed. "
+              << (decompressing != nullptr && !decompressing->error.empty()
+                      ? decompressing->error
+                      : ingest.error)
+              << std::endl;
 
-  return messages;
+  return parsed;
 }
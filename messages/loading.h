@@ -4,16 +4,17 @@
 #ifndef LOADING_H
 #define LOADING_H
 
-#include "../includes/json.hpp"
+#include "../common/decompressing_buffer.h"
 #include "../settings/settings.h"
+#include "filter.h"
+#include "ingest.h"
+#include "log_file.h"
 #include "message.h"
 #include "messages.h"
-#include <list>
-#include <map>
+#include <cstdint>
+#include <memory>
 #include <string>
 
-using json = nlohmann::json;
-
 namespace messages {
 
 class load {
@@ -21,28 +22,60 @@ public:
   // The generated messages object
   messages::structure messages;
 
-  // Constructor, loads and parses the messages log file, then calls the
-  // metadata methods
-  explicit load(const settings::structure &settings);
+  // Constructor, reads the messages log file, building the messages and their
+  // metadata as it goes. Takes the log file already mapped and scanned during
+  // verification, if there is one, so it isn't read twice
+  explicit load(const settings::structure &settings,
+                std::shared_ptr<messages::log_file> log_file = nullptr);
 
 private:
   // Path to the messages log file
   std::string messages_log_file;
 
-  // Parsed JSON messages log
-  json messages_log;
+  // How the messages log file is compressed, if it is
+  common::compression compression{common::compression::none};
+
+  // The mapped messages log file
+  std::shared_ptr<messages::log_file> log_file;
+
+  // Which records to build messages from
+  std::shared_ptr<const messages::filter> filter;
+
+  // How far into the log file its records were read, 0 if that isn't known
+  std::uint64_t parsed_until{0};
+
+  // Method to map the log file, if verification didn't already, and it isn't
+  // compressed
+  bool map_log_file();
+
+  // Method to map the log file and find all its records, if they weren't
+  // found already
+  bool scan_log_file();
+
+  // Method to read the records out of the memory mapped log file, with the
+  // message bodies viewing straight into the mapping
+  bool load_mapped(messages::ingest &ingest);
+
+  // Method to read only the records sent within the filter's time range,
+  // found through the log's time index
+  bool load_time_range(messages::ingest &ingest);
 
-  // Metadata about the messages
-  // Owner of the messages
-  std::string get_messages_owner();
+  // Method to read a range of records out of the memory mapped log file, split
+  // into chunks that are read on separate threads
+  bool read_chunked(messages::ingest &ingest, std::size_t first,
+                    std::size_t last);
 
-  // Number of messages
-  int get_number_of_messages();
+  // Method to read only the records added to the log since it was restored
+  // from the session cache
+  bool load_appended(messages::ingest &ingest, std::uint64_t restored_until);
 
-  // Number of participants
-  int get_number_of_participants();
+  // Method to read a range of records out of the memory mapped log file
+  bool read_records(messages::ingest &ingest, std::size_t first,
+                    std::size_t last);
 
-  std::list<messages::message> get_messages();
+  // Method to stream the log file through the parser, decompressing it on the
+  // way if needed, for when it can't be mapped
+  bool load_streamed(messages::ingest &ingest);
 };
 
 } // namespace messages
@@ -0,0 +1,305 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "log_file.h"
+#include <charconv>
+
+namespace messages {
+
+//<editor-fold desc="Scanning">
+// Method to skip past whitespace, returning the index of the next character
+static std::size_t skip_whitespace(std::string_view text, std::size_t i) {
+  while (i < text.size() && (text[i] == ' ' || text[i] == '\n' ||
+                             text[i] == '\r' || text[i] == '\t'))
+    i++;
+  return i;
+}
+
+// Method to find the closing quote of the string opened at i
+static std::size_t find_string_end(std::string_view text, std::size_t i) {
+  for (i++; i < text.size(); i++) {
+    // Skip over whatever is escaped
+    if (text[i] == '\\')
+      i++;
+    else if (text[i] == '"')
+      return i;
+  }
+
+  return std::string_view::npos;
+}
+
+// Method to skip past the value starting at i, returning the index after it
+static std::size_t skip_value(std::string_view text, std::size_t i) {
+  if (i >= text.size())
+    return std::string_view::npos;
+
+  // Strings
+  if (text[i] == '"') {
+    std::size_t end = find_string_end(text, i);
+    return end == std::string_view::npos ? end : end + 1;
+  }
+
+  // Objects and arrays, skipping over any strings inside them
+  if (text[i] == '{' || text[i] == '[') {
+    int depth = 0;
+    for (; i < text.size(); i++) {
+      if (text[i] == '"') {
+        i = find_string_end(text, i);
+        if (i == std::string_view::npos)
+          return i;
+      } else if (text[i] == '{' || text[i] == '[')
+        depth++;
+      else if (text[i] == '}' || text[i] == ']') {
+        depth--;
+        if (depth == 0)
+          return i + 1;
+      }
+    }
+    return std::string_view::npos;
+  }
+
+  // Numbers, true, false, and null
+  while (i < text.size() && text[i] != ',' && text[i] != '}' &&
+         text[i] != ']' && text[i] != ' ' && text[i] != '\n' &&
+         text[i] != '\r' && text[i] != '\t')
+    i++;
+  return i;
+}
+
+// Method to read the four hex digits of a \u escape, false if they aren't any
+static bool read_hex(std::string_view text, std::size_t i, char32_t &value) {
+  if (i + 4 > text.size())
+    return false;
+
+  unsigned int parsed = 0;
+  auto [end, error] =
+      std::from_chars(text.data() + i, text.data() + i + 4, parsed, 16);
+  value = char32_t(parsed);
+
+  return error == std::errc() && end == text.data() + i + 4;
+}
+
+// Method to find where the array of records opens, or npos if it doesn't
+static std::size_t find_array_start(std::string_view text) {
+  std::size_t i = 0;
+
+  // Skip a byte order mark, if there is one
+  if (text.starts_with("\xEF\xBB\xBF"))
+    i = 3;
+
+  // Logs are one array
+  i = skip_whitespace(text, i);
+  if (i >= text.size() || text[i] != '[')
+    return std::string_view::npos;
+
+  return i;
+}
+//</editor-fold>
+
+log_file::log_file(const std::string &path, bool scan_records) {
+  this->file = std::make_shared<common::mapped_file>(path);
+  if (!this->file->is_open())
+    return;
+
+  if (scan_records)
+    this->is_valid = this->find_records();
+  else
+    this->is_valid =
+        find_array_start(this->file->contents()) != std::string_view::npos;
+}
+
+bool log_file::find_records() {
+  std::string_view text = this->file->contents();
+  this->records.clear();
+  this->is_scanned = true;
+
+  std::size_t i = find_array_start(text);
+  if (i == std::string_view::npos)
+    return this->is_valid = false;
+  i = skip_whitespace(text, i + 1);
+
+  // Of nothing
+  if (i < text.size() && text[i] == ']')
+    return this->is_valid = skip_whitespace(text, i + 1) == text.size();
+
+  // Or of objects, one per record
+  return this->is_valid = this->find_records_from(i);
+}
+
+bool log_file::find_records_after(std::size_t offset) {
+  std::string_view text = this->file->contents();
+  this->records.clear();
+  if (offset > text.size())
+    return false;
+
+  // The log either ends where the last record did, or carries on with more
+  std::size_t i = skip_whitespace(text, offset);
+  if (i < text.size() && text[i] == ']')
+    return skip_whitespace(text, i + 1) == text.size();
+  if (i >= text.size() || text[i] != ',')
+    return false;
+
+  return this->find_records_from(skip_whitespace(text, i + 1));
+}
+
+bool log_file::find_records_from(std::size_t i) {
+  std::string_view text = this->file->contents();
+
+  while (true) {
+    if (i >= text.size() || text[i] != '{')
+      return false;
+
+    std::size_t end = skip_value(text, i);
+    if (end == std::string_view::npos)
+      return false;
+    this->records.emplace_back(i, end);
+
+    // Move onto the next record, or the end of the array
+    i = skip_whitespace(text, end);
+    if (i < text.size() && text[i] == ',') {
+      i = skip_whitespace(text, i + 1);
+      continue;
+    }
+    if (i < text.size() && text[i] == ']')
+      return skip_whitespace(text, i + 1) == text.size();
+
+    return false;
+  }
+}
+
+bool log_file::read_record(std::size_t record, raw_record &fields) const {
+  auto [start, end] = this->records[record];
+  std::string_view text = this->file->contents().substr(start, end - start);
+
+  std::size_t i = skip_whitespace(text, 1);
+  if (i < text.size() && text[i] == '}')
+    return true;
+
+  // Read each key and value pair on the record
+  while (i < text.size()) {
+    // Read the key
+    if (text[i] != '"')
+      return false;
+    std::size_t key_end = find_string_end(text, i);
+    if (key_end == std::string_view::npos)
+      return false;
+    std::string_view key = text.substr(i + 1, key_end - i - 1);
+
+    i = skip_whitespace(text, key_end + 1);
+    if (i >= text.size() || text[i] != ':')
+      return false;
+    i = skip_whitespace(text, i + 1);
+
+    // Read the value, keeping only the string fields that are used
+    if (i < text.size() && text[i] == '"') {
+      std::size_t value_end = find_string_end(text, i);
+      if (value_end == std::string_view::npos)
+        return false;
+      std::string_view value = text.substr(i + 1, value_end - i - 1);
+
+      if (key == "SenderName")
+        fields.sender_name = value;
+      else if (key == "Message")
+        fields.message = value;
+      else if (key == "DateSent")
+        fields.date_sent = value;
+      else if (key == "OwnerId")
+        fields.owner_id = value;
+
+      i = value_end + 1;
+    } else {
+      i = skip_value(text, i);
+      if (i == std::string_view::npos)
+        return false;
+    }
+
+    // Move onto the next pair, or the end of the record
+    i = skip_whitespace(text, i);
+    if (i < text.size() && text[i] == ',')
+      i = skip_whitespace(text, i + 1);
+    else
+      return i < text.size() && text[i] == '}';
+  }
+
+  return false;
+}
+
+bool raw_record::is_escaped(std::string_view field) {
+  return field.find('\\') != std::string_view::npos;
+}
+
+std::pmr::string raw_record::unescape(std::string_view field) {
+  std::pmr::string result;
+  result.reserve(field.size());
+
+  for (std::size_t i = 0; i < field.size(); i++) {
+    // Copy over anything that isn't escaped
+    if (field[i] != '\\' || i + 1 >= field.size()) {
+      result += field[i];
+      continue;
+    }
+
+    i++;
+    switch (field[i]) {
+    case 'b':
+      result += '\b';
+      break;
+    case 'f':
+      result += '\f';
+      break;
+    case 'n':
+      result += '\n';
+      break;
+    case 'r':
+      result += '\r';
+      break;
+    case 't':
+      result += '\t';
+      break;
+    case 'u': {
+      char32_t code_point;
+      if (!read_hex(field, i + 1, code_point)) {
+        result += "\\u";
+        break;
+      }
+      i += 4;
+
+      // Join UTF-16 surrogate pairs back into one code point
+      char32_t low;
+      if (code_point >= 0xD800 && code_point <= 0xDBFF &&
+          i + 2 < field.size() && field[i + 1] == '\\' &&
+          field[i + 2] == 'u' && read_hex(field, i + 3, low)) {
+        if (low >= 0xDC00 && low <= 0xDFFF) {
+          code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+          i += 6;
+        }
+      }
+
+      // Encode the code point as UTF-8
+      if (code_point < 0x80)
+        result += char(code_point);
+      else if (code_point < 0x800) {
+        result += char(0xC0 | (code_point >> 6));
+        result += char(0x80 | (code_point & 0x3F));
+      } else if (code_point < 0x10000) {
+        result += char(0xE0 | (code_point >> 12));
+        result += char(0x80 | ((code_point >> 6) & 0x3F));
+        result += char(0x80 | (code_point & 0x3F));
+      } else {
+        result += char(0xF0 | (code_point >> 18));
+        result += char(0x80 | ((code_point >> 12) & 0x3F));
+        result += char(0x80 | ((code_point >> 6) & 0x3F));
+        result += char(0x80 | (code_point & 0x3F));
+      }
+      break;
+    }
+    default:
+      // Quotes, slashes, and backslashes are just themselves
+      result += field[i];
+    }
+  }
+
+  return result;
+}
+
+} // namespace messages
@@ -0,0 +1,76 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_LOG_FILE_H
+#define XIVRP_FORMATTER_LOG_FILE_H
+
+#include "../common/mapped_file.h"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace messages {
+
+// The fields of one record in the log, as views into the mapped file. The
+// views are of the raw JSON string contents, so any with escapes in them still
+// need unescaped before use
+struct raw_record {
+public:
+  std::string_view sender_name;
+  std::string_view message;
+  std::string_view date_sent;
+  std::string_view owner_id;
+
+  // Method to check if a field still has JSON escapes in it
+  static bool is_escaped(std::string_view field);
+
+  // Method to unescape a field's JSON escapes into an owned string
+  static std::pmr::string unescape(std::string_view field);
+};
+
+// A ChatScanner log mapped into memory, with the byte range of every record
+// found, so records can be read straight out of the mapping
+class log_file {
+public:
+  // Constructor, maps the log and finds its records; or, if they might not be
+  // needed, i.e. when the log is restored from its session cache or its time
+  // index, only checks that it starts like a log
+  explicit log_file(const std::string &path, bool scan_records = true);
+
+  // Whether the file was mapped, and was shaped like a log
+  bool is_valid{false};
+
+  // Whether the whole log has been scanned for its records
+  bool is_scanned{false};
+
+  // The mapped file, shared with anything that views into it
+  std::shared_ptr<common::mapped_file> file;
+
+  // The start and end offsets of each record in the file, or only of those
+  // after an offset, once find_records_after is used
+  std::vector<std::pair<std::size_t, std::size_t>> records;
+
+  // Method to read the fields of a record, false if it is not a flat object
+  bool read_record(std::size_t record, raw_record &fields) const;
+
+  // Method to find where each record starts and ends, scanning the whole log,
+  // and whether it was shaped like a log
+  bool find_records();
+
+  // Method to find just the records after an offset where a record ended,
+  // i.e. those added onto the log since it was last read, without scanning
+  // what comes before; false if the rest isn't shaped like the end of a log
+  bool find_records_after(std::size_t offset);
+
+private:
+  // Method to find the records from the start of one to the end of the log
+  bool find_records_from(std::size_t i);
+};
+
+} // namespace messages
+
+#endif // XIVRP_FORMATTER_LOG_FILE_H
@@ -0,0 +1,227 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "markers.h"
+#include <charconv>
+
+namespace messages {
+
+// A mark, where it goes on a message, and what it means there
+struct marker_rule {
+  std::string_view mark;
+  bool at_start;
+  std::uint8_t meaning;
+};
+
+//<editor-fold desc="Usual Marks">
+// The marks used unless the settings give others. "(#/#)" at the end of a
+// message is always checked for, with what it means depending on the numbers
+const std::vector<marker_rule> usual_marks = {
+    {"...", false, markers::continued},
+    {"..", false, markers::continued},
+    {"…", false, markers::continued},
+    {">>", false, markers::continued},
+    {"cont", false, markers::continued},
+    {"cont.", false, markers::continued},
+    {"cont.)", false, markers::continued},
+    {"cont)", false, markers::continued},
+    {"-", false, markers::continued},
+
+    {"...", true, markers::continuation},
+    {"..", true, markers::continuation},
+    {"…", true, markers::continuation},
+    {"-", true, markers::continuation},
+
+    {"[", true, markers::out_of_character},
+    {"(", true, markers::out_of_character},
+    {"{", true, markers::out_of_character},
+    {"<", true, markers::out_of_character},
+};
+//</editor-fold>
+
+// Longest number read from a "(#/#)", so reading it stays bounded
+const std::size_t longest_part_number = 4;
+
+static bool is_digit(char character) {
+  return character >= '0' && character <= '9';
+}
+
+markers::markers() {
+  for (const auto &rule : usual_marks)
+    this->add(rule.mark, rule.at_start, rule.meaning);
+}
+
+markers::markers(const settings::structure &settings) {
+  this->add_marks(settings.continued_marks, false, continued);
+  this->add_marks(settings.continuation_marks, true, continuation);
+  this->add_marks(settings.out_of_character_marks, true, out_of_character);
+}
+
+//<editor-fold desc="Compiling">
+void markers::add(std::string_view mark, bool at_start, std::uint8_t meaning) {
+  // Marks at the end are matched from the end of messages, so are added to
+  // their trie backwards
+  auto &trie = at_start ? this->leading : this->trailing;
+  int current = 0;
+
+  for (std::size_t index = 0; index < mark.size(); index++) {
+    char character = at_start ? mark[index] : mark[mark.size() - 1 - index];
+
+    int next = -1;
+    for (const auto &[child_character, child] : trie[current].children)
+      if (child_character == character)
+        next = child;
+
+    if (next == -1) {
+      next = int(trie.size());
+      trie[current].children.emplace_back(character, next);
+      trie.emplace_back();
+    }
+    current = next;
+  }
+
+  trie[current].meanings |= meaning;
+}
+
+void markers::add_marks(const std::string &marks, bool at_start,
+                        std::uint8_t meaning) {
+  // A blank setting keeps the usual marks
+  if (marks.empty()) {
+    for (const auto &rule : usual_marks)
+      if (rule.at_start == at_start && rule.meaning == meaning)
+        this->add(rule.mark, at_start, meaning);
+    return;
+  }
+
+  this->description += std::to_string(meaning) + ":" + marks + ";";
+
+  // Spaces are skipped over when matching, so they can separate the marks
+  std::size_t start = 0;
+  while (start < marks.size()) {
+    auto end = marks.find(' ', start);
+    if (end == std::string::npos)
+      end = marks.size();
+
+    if (end > start)
+      this->add(std::string_view(marks).substr(start, end - start), at_start,
+                meaning);
+    start = end + 1;
+  }
+}
+//</editor-fold>
+
+//<editor-fold desc="Matching">
+std::uint8_t markers::classify(std::string_view text) const {
+  // A mark has to leave something else in the message, so only the characters
+  // between the first and last ones that aren't spaces can be part of one
+  auto first = text.find_first_not_of(' ');
+  if (first == std::string_view::npos)
+    return 0;
+  auto last = text.find_last_not_of(' ');
+  text = text.substr(first, last - first + 1);
+
+  std::uint8_t meanings = 0;
+
+  // Walk the start of the message down the trie of leading marks, picking up
+  // the meaning of every mark passed along the way
+  int current = 0;
+  for (std::size_t index = 0; index + 1 < text.size(); index++) {
+    if (text[index] == ' ')
+      continue;
+
+    int next = -1;
+    for (const auto &[character, child] : this->leading[current].children)
+      if (character == text[index])
+        next = child;
+    if (next == -1)
+      break;
+
+    current = next;
+    meanings |= this->leading[current].meanings;
+  }
+
+  // And the same from the end
+  current = 0;
+  for (std::size_t index = text.size() - 1; index > 0; index--) {
+    if (text[index] == ' ')
+      continue;
+
+    int next = -1;
+    for (const auto &[character, child] : this->trailing[current].children)
+      if (character == text[index])
+        next = child;
+    if (next == -1)
+      break;
+
+    current = next;
+    meanings |= this->trailing[current].meanings;
+  }
+
+  return meanings | classify_part_count(text);
+}
+
+std::uint8_t markers::classify_part_count(std::string_view text) {
+  std::size_t position = text.size();
+
+  // Method to step back over any spaces, to the character before them
+  auto previous = [&]() {
+    while (position > 0 && text[position - 1] == ' ')
+      position--;
+    return position > 0 ? text[position - 1] : '\0';
+  };
+
+  // Method to read the number ending at the current position, or -1
+  auto read_number = [&]() {
+    auto end = position;
+    while (position > 0 && is_digit(text[position - 1]) &&
+           end - position < longest_part_number)
+      position--;
+    if (position == end || (position > 0 && is_digit(text[position - 1])))
+      return -1;
+
+    int number = 0;
+    std::from_chars(text.data() + position, text.data() + end, number);
+    return number;
+  };
+
+  //<editor-fold desc="Reading">
+  if (previous() != ')')
+    return 0;
+  position--;
+
+  // The total can be unknown, i.e. "(1/?)"
+  int total = -1;
+  if (previous() == '?')
+    while (position > 0 && text[position - 1] == '?')
+      position--;
+  else if ((total = read_number()) == -1)
+    return 0;
+
+  if (previous() != '/')
+    return 0;
+  position--;
+
+  previous();
+  int part = read_number();
+  if (part == -1)
+    return 0;
+
+  if (previous() == '(')
+    position--;
+
+  // It can't be all there is to the message
+  if (previous() == '\0')
+    return 0;
+  //</editor-fold>
+
+  std::uint8_t meanings = 0;
+  if (total == -1 || part < total)
+    meanings |= continued;
+  if (part >= 2 && (total == -1 || part <= total))
+    meanings |= continuation;
+
+  return meanings;
+}
+//</editor-fold>
+
+} // namespace messages
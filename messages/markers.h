@@ -0,0 +1,72 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_MARKERS_H
+#define XIVRP_FORMATTER_MARKERS_H
+
+#include "../settings/settings.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace messages {
+
+// Marks that say something about a message, from the table of usual marks or
+// the settings, compiled into tries of the marks at the start and end of
+// messages so a message is matched against all of them in one scan from
+// either end. Spaces in messages are skipped over, so "(1 / 2)" is "(1/2)"
+class markers {
+public:
+  // What a mark at the start or end of a message says about it
+  enum meaning : std::uint8_t {
+    // The message carries on in the next one, i.e. "..." at the end
+    continued = 1,
+    // The message carries on from the previous one, i.e. "..." at the start
+    continuation = 2,
+    // The message is out of character, i.e. "(" at the start
+    out_of_character = 4,
+  };
+
+  // Constructor for the usual marks
+  markers();
+
+  // Constructor, swapping in any marks given by the settings
+  explicit markers(const settings::structure &settings);
+
+  // Method to find what the marks at the ends of the text say about it, as
+  // meaning flags
+  [[nodiscard]] std::uint8_t classify(std::string_view text) const;
+
+  // Which marks were swapped in, so anything saved with different marks isn't
+  // reused
+  std::string description;
+
+private:
+  // A character in a trie of marks
+  struct node {
+    // The next characters, and the index of their nodes
+    std::vector<std::pair<char, int>> children;
+    // What a mark ending here means
+    std::uint8_t meanings{0};
+  };
+
+  // Tries of the marks at the start of messages, and at the end (backwards)
+  std::vector<node> leading{1};
+  std::vector<node> trailing{1};
+
+  // Method to add a mark to the trie for its end of messages
+  void add(std::string_view mark, bool at_start, std::uint8_t meaning);
+
+  // Method to add the marks from the settings, separated by spaces, or the
+  // usual ones if the setting is blank
+  void add_marks(const std::string &marks, bool at_start,
+                 std::uint8_t meaning);
+
+  // Method to find what a "(#/#)" at the end of the text means, if it has one
+  static std::uint8_t classify_part_count(std::string_view text);
+};
+
+} // namespace messages
+
+#endif // XIVRP_FORMATTER_MARKERS_H
@@ -4,86 +4,85 @@
 #ifndef MESSAGE_H
 #define MESSAGE_H
 
-#include <chrono>
-#include <list>
+#include <cstddef>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 
 namespace messages {
 
 // Just using a struct wrapper for the message body to use chain calls for html
-// and print/actual versions of the message
+// and print/actual versions of the message. What the body owns is allocated
+// from the default memory resource, i.e. the run's arena
 struct message_body {
 public:
-  explicit message_body(std::string content);
+  explicit message_body(std::pmr::string content);
 
-  // Methods to get the contents out in usable formats
-  std::string to_html();
-  std::string to_print();
-  std::string to_str();
-
-  // Method to remove continuation marks
-  void remove_continuation_marks();
+  // Constructor, copying the content in
+  explicit message_body(std::string_view content);
 
-private:
-  std::string content;
-};
-
-struct message {
-public:
-  // Metadata about the message
-  int id;
+  // Method to make a body that views text owned elsewhere, i.e. the mapped log
+  // file, which is only copied once something rewrites it
+  static message_body borrow(std::string_view content);
 
-  // Author of the message
-  std::string author;
+  // Method to copy borrowed content in, so the body no longer needs what it
+  // was viewing
+  void own();
 
-  // Content of the message
-  messages::message_body content;
+  // Method to make a body from content that is already HTML, i.e. with
+  // emphatics highlighted, so it isn't escaped again
+  static message_body html(std::pmr::string content);
 
-  // Number of words of message
-  int message_length;
-
-  // Time of the message
-  std::string datetime;
-  std::string into_session;
-  std::chrono::system_clock::time_point time;
+  // Methods to get the contents out in usable formats
+  std::string to_html();
+  std::string_view to_print();
 
-  message(int id, std::string author, messages::message_body content,
-          std::chrono::system_clock::time_point start_time,
-          std::chrono::system_clock::time_point message_time);
+  // Method to measure how long some content will be once printed, without
+  // printing it
+  static std::size_t print_size(std::string_view content);
 
-  // Method to highlight ~emphatics~
-  void highlight_emphatics(const std::string &color);
+  // Method to remove continuation marks
+  void remove_continuation_marks();
 
-  // Method to format the message into HTML
-  std::string format();
+  // Method to get the content, wherever it is
+  [[nodiscard]] std::string_view text() const;
 
-  // Metadata about the message
-  bool is_continued = false;
-  bool is_continuation = false;
-  bool has_emphatics = false;
-  bool is_ooc = false;
-  int session_ID = 0;
-  bool has_gap_after = false;
+private:
+  message_body() = default;
 
-  // Duration of a gap after the message
-  std::chrono::duration<double> gap_duration{0};
+  // The content, when the body owns it
+  std::pmr::string content;
 
-  // Actual time of the messages
-  std::chrono::duration<double> elapsed_time;
+  // The content, when the body is viewing it from elsewhere
+  std::string_view borrowed_content;
+  bool is_borrowed{false};
 
-private:
-  // Method to check for continuation
-  void check_for_continuation();
+  // Whether the content is already HTML
+  bool is_html{false};
 
-  // Method to check for emphatics
-  void check_for_emphatics();
+  // The content decoded for printing, kept until the content is rewritten.
+  // Content without escapes prints as it is, so it's only copied here if it
+  // has some
+  std::pmr::string printed;
+  bool is_printed{false};
+  bool is_decoded{false};
 
-  // Method to check for OOC
-  void check_for_ooc();
+  // Method to decode the content for printing, if it hasn't been already
+  void print();
+};
 
-  // Method to set the time data
-  void set_time_data(std::chrono::system_clock::time_point start_time,
-                     std::chrono::system_clock::time_point message_time);
+// What is worked out about a message from its content
+struct message_flags {
+  // Whether the message carries on in the next one
+  bool is_continued : 1 {false};
+  // Whether the message carries on from the previous one
+  bool is_continuation : 1 {false};
+  // Whether the message has any emphatic marks to highlight
+  bool has_emphatics : 1 {false};
+  // Whether the message is out of character
+  bool is_ooc : 1 {false};
+  // Whether there is a gap in the session after the message
+  bool has_gap_after : 1 {false};
 };
 
 } // namespace messages
@@ -0,0 +1,189 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "message_store.h"
+#include "../common/text.h"
+#include "../includes/date.h"
+#include "continuation_marks.h"
+#include "markers.h"
+#include <iterator>
+#include <utility>
+
+namespace messages {
+
+void message_store::add(int id, int author_id, messages::message_body body,
+                        std::chrono::system_clock::time_point start_time,
+                        std::chrono::system_clock::time_point time,
+                        const messages::markers &markers) {
+  const auto &text = body.to_print();
+
+  // The words and emphatics take one pass over the message, leaving out the
+  // continuation marks that combining trims off, and marks are only looked
+  // for a few characters in from either end
+  auto [start, end] = messages::continuation_marks::trim(text);
+  auto scan = common::text::scan(text.substr(start, end - start));
+  auto meanings = markers.classify(text);
+
+  messages::message_flags flags;
+  flags.has_emphatics = scan.has_emphatic_marks;
+  flags.is_continued = meanings & messages::markers::continued;
+  flags.is_continuation = meanings & messages::markers::continuation;
+  flags.is_ooc = meanings & messages::markers::out_of_character;
+
+  this->add(id, author_id, std::move(body), start_time, time, int(scan.words),
+            int(scan.cjk_characters), flags);
+}
+
+void message_store::add(int id, int author_id, messages::message_body body,
+                        std::chrono::system_clock::time_point start_time,
+                        std::chrono::system_clock::time_point time,
+                        int message_length, int cjk_characters,
+                        messages::message_flags flags) {
+  this->ids.push_back(id);
+  this->author_ids.push_back(author_id);
+  this->times.push_back(time);
+  this->elapsed_times.emplace_back(time - start_time);
+  this->flags.push_back(flags);
+  this->message_lengths.push_back(message_length);
+  this->cjk_characters.push_back(cjk_characters);
+  this->gap_durations.emplace_back(0);
+  this->bodies.push_back(std::move(body));
+}
+
+// Method to add one column onto the end of another
+template <typename column>
+static void append_column(column &to, column &&from) {
+  to.insert(to.end(), std::make_move_iterator(from.begin()),
+            std::make_move_iterator(from.end()));
+}
+
+void message_store::append(messages::message_store &&other) {
+  append_column(this->ids, std::move(other.ids));
+  append_column(this->author_ids, std::move(other.author_ids));
+  append_column(this->times, std::move(other.times));
+  append_column(this->elapsed_times, std::move(other.elapsed_times));
+  append_column(this->flags, std::move(other.flags));
+  append_column(this->message_lengths, std::move(other.message_lengths));
+  append_column(this->cjk_characters, std::move(other.cjk_characters));
+  append_column(this->gap_durations, std::move(other.gap_durations));
+  append_column(this->bodies, std::move(other.bodies));
+}
+
+// Method to rebuild one column in a new order
+template <typename column>
+static void reorder_column(column &values,
+                           const std::vector<std::size_t> &order) {
+  column reordered;
+  reordered.reserve(values.size());
+  for (auto index : order)
+    reordered.push_back(std::move(values[index]));
+  values = std::move(reordered);
+}
+
+void message_store::reorder(const std::vector<std::size_t> &order) {
+  reorder_column(this->ids, order);
+  reorder_column(this->author_ids, order);
+  reorder_column(this->times, order);
+  reorder_column(this->elapsed_times, order);
+  reorder_column(this->flags, order);
+  reorder_column(this->message_lengths, order);
+  reorder_column(this->cjk_characters, order);
+  reorder_column(this->gap_durations, order);
+  reorder_column(this->bodies, order);
+}
+
+void message_store::move(std::size_t from, std::size_t to) {
+  if (from == to)
+    return;
+
+  this->ids[to] = this->ids[from];
+  this->author_ids[to] = this->author_ids[from];
+  this->times[to] = this->times[from];
+  this->elapsed_times[to] = this->elapsed_times[from];
+  this->flags[to] = this->flags[from];
+  this->message_lengths[to] = this->message_lengths[from];
+  this->cjk_characters[to] = this->cjk_characters[from];
+  this->gap_durations[to] = this->gap_durations[from];
+  this->bodies[to] = std::move(this->bodies[from]);
+}
+
+void message_store::truncate(std::size_t size) {
+  this->ids.resize(size);
+  this->author_ids.resize(size);
+  this->times.resize(size);
+  this->elapsed_times.resize(size);
+  this->flags.resize(size);
+  this->message_lengths.resize(size);
+  this->cjk_characters.resize(size);
+  this->gap_durations.resize(size);
+  // Bodies can't be made from nothing, so they can only be erased
+  this->bodies.erase(this->bodies.begin() + std::ptrdiff_t(size),
+                     this->bodies.end());
+}
+
+void message_store::reserve(std::size_t size) {
+  this->ids.reserve(size);
+  this->author_ids.reserve(size);
+  this->times.reserve(size);
+  this->elapsed_times.reserve(size);
+  this->flags.reserve(size);
+  this->message_lengths.reserve(size);
+  this->cjk_characters.reserve(size);
+  this->gap_durations.reserve(size);
+  this->bodies.reserve(size);
+}
+
+void message_store::measure_from(
+    std::chrono::system_clock::time_point start_time) {
+  for (std::size_t index = 0; index < this->size(); index++)
+    this->elapsed_times[index] = this->times[index] - start_time;
+}
+
+void message_store::format(std::size_t index, const std::string &author,
+                           bool compact_markup, std::string &html) {
+  // Spacers fill the columns either side of the message in the template's
+  // grid, unless it lays the grid out without them
+  std::string_view spacer = compact_markup ? "" : "<div></div>";
+  auto id = std::to_string(this->ids[index]);
+
+  // Written straight onto the end of the HTML, rather than built up on its own
+  // first
+  html += spacer;
+  html += "<a class='message' href='#";
+  html += id;
+  html += "' id='";
+  html += id;
+  html += "'><div class='header'>";
+  html += common::text::escape_html(author);
+  html += "</div><div class='body'>";
+  html += this->bodies[index].to_html();
+  html += "</div><div class='footer'>";
+  html += date::format("%F T %H:%M",
+                       floor<std::chrono::milliseconds>(this->times[index]));
+  html += " (";
+  html += this->into_session(index);
+  html += " in)</div></a>";
+  html += spacer;
+  html += '\n';
+
+  if (this->flags[index].has_gap_after) {
+    html += spacer;
+    html += "<div class=\"message_gap_notice\">Gap of ";
+    html += date::format("%R", floor<std::chrono::milliseconds>(
+                                   this->gap_durations[index]));
+    html += " found. Adjusting all time-in figures hereafter.</div>";
+    html += spacer;
+    html += '\n';
+  }
+}
+
+std::string message_store::into_session(std::size_t index) const {
+  return date::format(
+      "%R", floor<std::chrono::milliseconds>(this->elapsed_times[index]));
+}
+
+std::size_t message_store::size() const { return this->ids.size(); }
+
+bool message_store::empty() const { return this->ids.empty(); }
+
+} // namespace messages
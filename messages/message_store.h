@@ -0,0 +1,108 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_MESSAGE_STORE_H
+#define XIVRP_FORMATTER_MESSAGE_STORE_H
+
+#include "message.h"
+#include <chrono>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace messages {
+
+class markers;
+
+// The messages, kept column by column in contiguous arrays. Passes over the
+// messages mostly look at a few small fields of each, i.e. times, authors and
+// flags, so those are packed together, apart from the text. Messages are
+// referred to by their index, which only changes when messages are reordered
+// or removed. The columns come from the default memory resource, i.e. the
+// run's arena
+class message_store {
+public:
+  message_store() = default;
+
+  // Stores are handed on by moving them, as copying one copies every message
+  message_store(const message_store &) = delete;
+  message_store &operator=(const message_store &) = delete;
+  message_store(message_store &&) = default;
+  message_store &operator=(message_store &&) = default;
+
+  // Method to add a message, classifying it by the given marks
+  void add(int id, int author_id, messages::message_body body,
+           std::chrono::system_clock::time_point start_time,
+           std::chrono::system_clock::time_point time,
+           const messages::markers &markers);
+
+  // Method to add a message restored from a session cache, which already
+  // knows everything that would be worked out from the body
+  void add(int id, int author_id, messages::message_body body,
+           std::chrono::system_clock::time_point start_time,
+           std::chrono::system_clock::time_point time, int message_length,
+           int cjk_characters, messages::message_flags flags);
+
+  // Method to add the messages from another store onto the end of this one
+  void append(messages::message_store &&other);
+
+  // Method to put the messages in a new order, given as the index each
+  // position should take its message from
+  void reorder(const std::vector<std::size_t> &order);
+
+  // Method to move a message to an earlier index, over whatever was there,
+  // for passes that remove messages as they go
+  void move(std::size_t from, std::size_t to);
+
+  // Method to drop the messages from an index onwards
+  void truncate(std::size_t size);
+
+  // Method to make room for a number of messages up front
+  void reserve(std::size_t size);
+
+  // Method to measure every message's time into the session from a new start
+  void measure_from(std::chrono::system_clock::time_point start_time);
+
+  // Method to format a message into HTML, under its author's name, with or
+  // without the spacers around it, onto the end of the given HTML
+  void format(std::size_t index, const std::string &author,
+              bool compact_markup, std::string &html);
+
+  // Method to format a message's time into the session
+  [[nodiscard]] std::string into_session(std::size_t index) const;
+
+  // Number of messages
+  [[nodiscard]] std::size_t size() const;
+  [[nodiscard]] bool empty() const;
+
+  //<editor-fold desc="Columns">
+  // Metadata about each message
+  std::pmr::vector<int> ids;
+
+  // Author of each message, as their id in the session's author table
+  std::pmr::vector<int> author_ids;
+
+  // Time of each message, and how far into the session it is
+  std::pmr::vector<std::chrono::system_clock::time_point> times;
+  std::pmr::vector<std::chrono::duration<double>> elapsed_times;
+
+  // What is worked out about each message
+  std::pmr::vector<messages::message_flags> flags;
+
+  // Number of words of each message, and how many are CJK characters
+  std::pmr::vector<int> message_lengths;
+  std::pmr::vector<int> cjk_characters;
+
+  // Duration of the gap after each message, if it has one
+  std::pmr::vector<std::chrono::duration<double>> gap_durations;
+
+  // Content of each message, away from the rest since it's only read when
+  // combining, highlighting, and formatting
+  std::pmr::vector<messages::message_body> bodies;
+  //</editor-fold>
+};
+
+} // namespace messages
+
+#endif // XIVRP_FORMATTER_MESSAGE_STORE_H
@@ -3,51 +3,121 @@
 
 #include "messages.h"
 #include "../common/utilities.h"
+#include "../common/text.h"
 #include "../images/related_images.h"
 #include "../includes/date.h"
+#include "emphatics.h"
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <numeric>
 #include <utility>
+#include <vector>
+
+// Reading speeds for the read time estimate, per minute
+const int words_per_minute = 200;
+const int cjk_characters_per_minute = 500;
 
 messages::structure::structure(
     std::string owner, int number_of_messages, // NOLINT(*-pro-type-member-init)
-    int number_of_participants, std::list<messages::message> messages,
+    messages::author_table authors, messages::message_store messages,
     std::chrono::system_clock::time_point start_time,
     std::chrono::system_clock::time_point end_time) {
   this->owner = std::move(owner);
   this->number_of_messages = number_of_messages;
-  this->number_of_participants = number_of_participants;
+  this->number_of_participants = authors.size();
+  this->authors = std::move(authors);
   this->messages = std::move(messages);
   this->set_time_data(start_time, end_time);
 }
 
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "NullDereference"
+void messages::backing::keep(
+    const std::shared_ptr<common::mapped_file> &file) {
+  if (std::find(this->mapped_files.begin(), this->mapped_files.end(), file) ==
+      this->mapped_files.end())
+    this->mapped_files.push_back(file);
+}
+
+void messages::backing::release(
+    const std::shared_ptr<common::mapped_file> &file) {
+  this->mapped_files.remove(file);
+}
+
+int messages::structure::sort_by_time() {
+  auto &times = this->messages.times;
+
+  // Find where a message is earlier than the one before it, i.e. where each
+  // run of messages that are in order ends; most logs are already in order
+  std::vector<std::size_t> runs{0};
+  for (std::size_t index = 1; index < times.size(); index++)
+    if (times[index] < times[index - 1])
+      runs.push_back(index);
+  int out_of_order = int(runs.size()) - 1;
+  if (out_of_order == 0)
+    return 0;
+  runs.push_back(times.size());
+
+  // Merge the indexes of neighbouring runs together, twice as long each pass,
+  // so a few messages out of place only cost a few merges. Merging keeps
+  // messages sent at the same time in their original order
+  std::vector<std::size_t> order(times.size());
+  for (std::size_t index = 0; index < order.size(); index++)
+    order[index] = index;
+  auto earlier = [&times](std::size_t first, std::size_t second) {
+    return times[first] < times[second];
+  };
+  while (runs.size() > 2) {
+    std::vector<std::size_t> merged{0};
+    for (std::size_t run = 0; run + 1 < runs.size(); run += 2) {
+      if (run + 2 < runs.size())
+        std::inplace_merge(order.begin() + std::ptrdiff_t(runs[run]),
+                           order.begin() + std::ptrdiff_t(runs[run + 1]),
+                           order.begin() + std::ptrdiff_t(runs[run + 2]),
+                           earlier);
+      merged.push_back(runs[std::min(run + 2, runs.size() - 1)]);
+    }
+    runs = std::move(merged);
+  }
+
+  // Then move every column into that order at once
+  this->messages.reorder(order);
+
+  // Messages earlier than the first record start the session instead
+  auto start = std::min(this->start_time, times.front());
+  auto end = std::max(this->end_time, times.back());
+  if (start != this->start_time)
+    this->messages.measure_from(start);
+  this->set_time_data(start, end);
+
+  return out_of_order;
+}
+
 int messages::structure::combine(bool debug) {
-  std::list<messages::message> combined_messages;
+  auto &store = this->messages;
   int count = 0;
   int failed = 0;
-  std::string message_content;
+  std::string_view message_content;
+
+  // Messages that are kept are moved down over the ones combined into others,
+  // so everything before this index is already done with
+  std::size_t kept = 0;
 
   // Variables to track and build combination messages
-  message *message_seeking_continuation;
+  std::size_t message_seeking_continuation = 0;
   bool seeking_continuation = false;
-  std::string message_to_continue_author;
-  std::string message_to_combine_into;
-
-  // Add a filler message to the end of the list to make sure the last message
-  // can fail to continue if it needs to
-  this->messages.emplace_back(9999999999, "FILLER",
-                              messages::message_body("FILLER"),
-                              this->start_time, this->end_time);
+  int message_to_continue_author = -1;
+  std::pmr::string message_to_combine_into;
+  int words_to_combine = 0;
+  int cjk_characters_to_combine = 0;
 
   if (debug)
     std::cout << std::endl;
 
   // Iterate over the messages, and combine those that are continued
-  for (auto &message : this->messages) {
-    message.content.remove_continuation_marks();
-    message_content = message.content.to_str();
+  for (std::size_t index = 0; index < store.size(); index++) {
+    store.bodies[index].remove_continuation_marks();
+    message_content = store.bodies[index].text();
+    auto flags = store.flags[index];
 
     if (debug)
       std::cout << "'"
@@ -55,20 +125,22 @@ int messages::structure::combine(bool debug) {
                 << "' ... ";
 
     // If the message needs to be continued
-    if (message.is_continued && !seeking_continuation) {
+    if (flags.is_continued && !seeking_continuation) {
       if (debug)
         std::cout << "continuing ... " << std::endl;
 
       seeking_continuation = true;
-      message_to_continue_author = message.author;
+      message_to_continue_author = store.author_ids[index];
       message_to_combine_into = message_content;
-      message_seeking_continuation = &message;
+      words_to_combine = store.message_lengths[index];
+      cjk_characters_to_combine = store.cjk_characters[index];
+      message_seeking_continuation = index;
     }
 
     // If the message is a continuation of the previous message, combine it
     else if (seeking_continuation &&
-             (message.author == message_to_continue_author ||
-              message.is_continuation)) {
+             (store.author_ids[index] == message_to_continue_author ||
+              flags.is_continuation)) {
 
       if (debug)
         std::cout << "continuing '"
@@ -78,70 +150,80 @@ int messages::structure::combine(bool debug) {
                   << common::utilities::select_first_n_words(message_content, 5)
                   << "' ... " << std::endl;
 
-      // Add to the message
-      message_to_combine_into += " " + message_content;
+      // Add to the message, and its counts from when it was read
+      message_to_combine_into += ' ';
+      message_to_combine_into += message_content;
+      words_to_combine += store.message_lengths[index];
+      cjk_characters_to_combine += store.cjk_characters[index];
+      // The combined message has emphatics if any part of it does
+      if (flags.has_emphatics)
+        store.flags[message_seeking_continuation].has_emphatics = true;
 
       count++;
 
-      // If the message is the last in the continuation, add it to the list of
-      // combined messages
-      if (!message.is_continued) {
+      // If the message is the last in the continuation, keep the combined
+      // message
+      if (!flags.is_continued) {
         if (debug)
           std::cout << "fin" << std::endl;
 
+        auto &combined_flags = store.flags[message_seeking_continuation];
         // Unmark the message as continued
-        (*message_seeking_continuation).is_continued = false;
+        combined_flags.is_continued = false;
         // This isn't what the field was meant for, but since it will no longer
         // be used ... Mark the message as a continuation, to indicate that it
         // was combined
-        (*message_seeking_continuation).is_continuation = true;
+        combined_flags.is_continuation = true;
 
         // Set the content of the message to the combined content
-        (*message_seeking_continuation).content =
-            messages::message_body(message_to_combine_into);
+        store.bodies[message_seeking_continuation] =
+            messages::message_body(std::move(message_to_combine_into));
 
         // Set the message length
-        (*message_seeking_continuation).message_length =
-            common::utilities::count_words(message_to_combine_into);
+        store.message_lengths[message_seeking_continuation] = words_to_combine;
+        store.cjk_characters[message_seeking_continuation] =
+            cjk_characters_to_combine;
 
         // Save the message
-        combined_messages.push_back(*message_seeking_continuation);
+        store.move(message_seeking_continuation, kept++);
 
         // Reset continuation variables
         seeking_continuation = false;
-        message_to_continue_author = "";
+        message_to_continue_author = -1;
         message_to_combine_into = "";
-        message_seeking_continuation = nullptr;
       }
     }
 
     //<editor-fold desc="Non-continued messages, handling failures to continue">
-    // If the message is not a continuation, add it to the list of combined
-    // messages
+    // If the message is not a continuation, keep it
     else {
-      // If we failed to find the continuation, add the last message to the list
+      // If we failed to find the continuation, keep the last message too
       if (seeking_continuation) {
-        combined_messages.push_back(*message_seeking_continuation);
+        store.move(message_seeking_continuation, kept++);
         failed++;
       }
 
-      // Save the message, if it wasn't the filler at the end
-      if (message.author != "FILLER")
-        combined_messages.push_back(message);
+      // Save the message
+      store.move(index, kept++);
 
       // Reset continuation variables
       seeking_continuation = false;
-      message_to_continue_author = "";
+      message_to_continue_author = -1;
       message_to_combine_into = "";
-      message_seeking_continuation = nullptr;
     }
     //</editor-fold>
   }
 
-  // Set the messages to the combined messages
-  this->messages = combined_messages;
+  // If the last message failed to find its continuation, keep it too
+  if (seeking_continuation) {
+    store.move(message_seeking_continuation, kept++);
+    failed++;
+  }
+
+  // Drop what is left over past the kept messages
+  store.truncate(kept);
   // Update the message count
-  this->number_of_messages = int(this->messages.size());
+  this->number_of_messages = int(store.size());
 
   std::cout << "...Failed to continue " << failed << " message"
             << (failed != 1 ? "s" : "") << "." << std::endl;
@@ -149,34 +231,18 @@ int messages::structure::combine(bool debug) {
   // Return the number of messages that were combined
   return count;
 }
-#pragma clang diagnostic pop
-
-int messages::structure::remove_ooc() {
-  std::list<messages::message> messages_without_ooc;
-
-  // Iterate over the messages, and only keep those that are not Out Of
-  // Character
-  for (auto &message : this->messages)
-    if (!message.is_ooc)
-      messages_without_ooc.push_back(message);
 
-  int count = int(this->messages.size() - messages_without_ooc.size());
-
-  // Set the messages to the messages without OOC
-  this->messages = messages_without_ooc;
-  this->number_of_messages = int(this->messages.size());
-
-  // Return the number of messages that were removed
-  return count;
-}
-
-int messages::structure::highlight_emphatics(std::string color) {
+int messages::structure::highlight_emphatics() {
+  auto &store = this->messages;
   int count = 0;
 
-  // Iterate over the messages, and emphasize those that have emphatics
-  for (auto &message : this->messages)
-    if (message.has_emphatics) {
-      message.highlight_emphatics(color);
+  // Iterate over the messages, and emphasize those that have emphatics,
+  // escaping the text first so only the highlighting is left as HTML
+  for (std::size_t index = 0; index < store.size(); index++)
+    if (store.flags[index].has_emphatics) {
+      auto &body = store.bodies[index];
+      body = messages::message_body::html(messages::emphatics::highlight(
+          common::text::escape_html(body.to_print())));
       count++;
     }
 
@@ -184,49 +250,30 @@ int messages::structure::highlight_emphatics(std::string color) {
   return count;
 }
 
-std::map<std::string, std::string> messages::structure::format() {
+std::map<std::string, std::string>
+messages::structure::format(bool compact_markup) {
   std::map<std::string, std::string> template_ready_messages;
 
   // TODO: look for messages that are a long period apart, remove that time from
   //  the duration, and remove that time from the message's elapsed time
   //  (possibly do it somewhere other than here? a new check_for_breaks method?)
 
-  //<editor-fold desc="Authors">
-  // Iterate over the messages and find each author
-  std::list<std::string> authors;
-  for (auto &message : this->messages)
-    if (std::find(authors.begin(), authors.end(), message.author) ==
-        authors.end())
-      authors.push_back(message.author);
-
-  // Format the authors into a string
-  std::string formatted_authors;
-  // 1 Author
-  if (authors.size() == 1)
-    formatted_authors = authors.front();
-  // 2 Authors
-  else if (authors.size() == 2)
-    formatted_authors = authors.front() + " and " + authors.back();
-  // 3+ Authors
-  else {
-    for (auto &author : authors)
-      formatted_authors += author + ", ";
-    formatted_authors =
-        formatted_authors.substr(0, formatted_authors.size() - 2);
-  }
-
   template_ready_messages.insert(
-      std::pair<std::string, std::string>("authors", formatted_authors));
-  //</editor-fold>
+      std::pair<std::string, std::string>("authors", this->format_authors()));
 
   //<editor-fold desc="Metadata">
-  // Get the total number of words in this log
-  int word_count = 0;
-  for (auto &message : this->messages)
-    word_count += message.message_length;
-
-  // Get the average read time, assuming 200 words per minute
-  int average_read_time = word_count / 200;
+  // Get the total number of words in this log, and how many are CJK characters
+  auto &store = this->messages;
+  int word_count = std::accumulate(store.message_lengths.begin(),
+                                   store.message_lengths.end(), 0);
+  int cjk_count = std::accumulate(store.cjk_characters.begin(),
+                                  store.cjk_characters.end(), 0);
+
+  // Get the average read time, reading words and CJK characters at their own
+  // speeds
+  int average_read_time =
+      int(double(word_count - cjk_count) / words_per_minute +
+          double(cjk_count) / cjk_characters_per_minute);
 
   // Format the metadata into a string
   std::string metadata = std::to_string(this->number_of_messages) +
@@ -241,61 +288,44 @@ std::map<std::string, std::string> messages::structure::format() {
   //<editor-fold desc="Messages">
   // Iterate over the messages, and format them
   std::string formatted_messages;
-  for (auto &message : this->messages)
-    formatted_messages += message.format();
+  for (std::size_t index = 0; index < store.size(); index++)
+    store.format(index, this->authors.name(store.author_ids[index]),
+                 compact_markup, formatted_messages);
 
   template_ready_messages.insert(
-      std::pair<std::string, std::string>("messages", formatted_messages));
+      std::pair<std::string, std::string>("messages",
+                                          std::move(formatted_messages)));
   //</editor-fold>
 
-  std::cout << "..." << messages.size() << " messages formatted." << std::endl;
+  std::cout << "..." << store.size() << " messages formatted." << std::endl;
 
   // Return the formatted messages
   return template_ready_messages;
 }
 
 std::map<std::string, std::string>
-messages::structure::format(std::any structured_related_images) {
-  auto images = std::any_cast<related_images::structured_related_images>(
+messages::structure::format(std::any structured_related_images,
+                            bool compact_markup) {
+  auto &images = std::any_cast<related_images::structured_related_images &>(
       structured_related_images);
   std::map<std::string, std::string> template_ready_messages;
 
-  //<editor-fold desc="Authors">
-  // Iterate over the messages and find each author
-  std::list<std::string> authors;
-  for (auto &message : this->messages)
-    if (std::find(authors.begin(), authors.end(), message.author) ==
-        authors.end())
-      authors.push_back(message.author);
-
-  // Format the authors into a string
-  std::string formatted_authors;
-  // 1 Author
-  if (authors.size() == 1)
-    formatted_authors = authors.front();
-  // 2 Authors
-  else if (authors.size() == 2)
-    formatted_authors = authors.front() + " and " + authors.back();
-  // 3+ Authors
-  else {
-    for (auto &author : authors)
-      formatted_authors += author + ", ";
-    formatted_authors =
-        formatted_authors.substr(0, formatted_authors.size() - 2);
-  }
-
   template_ready_messages.insert(
-      std::pair<std::string, std::string>("authors", formatted_authors));
-  //</editor-fold>
+      std::pair<std::string, std::string>("authors", this->format_authors()));
 
   //<editor-fold desc="Metadata">
-  // Get the total number of words in this log
-  int word_count = 0;
-  for (auto &message : this->messages)
-    word_count += message.message_length;
-
-  // Get the average read time, assuming 200 words per minute
-  int average_read_time = word_count / 200;
+  // Get the total number of words in this log, and how many are CJK characters
+  auto &store = this->messages;
+  int word_count = std::accumulate(store.message_lengths.begin(),
+                                   store.message_lengths.end(), 0);
+  int cjk_count = std::accumulate(store.cjk_characters.begin(),
+                                  store.cjk_characters.end(), 0);
+
+  // Get the average read time, reading words and CJK characters at their own
+  // speeds
+  int average_read_time =
+      int(double(word_count - cjk_count) / words_per_minute +
+          double(cjk_count) / cjk_characters_per_minute);
 
   // Format the metadata into a string
   std::string metadata =
@@ -312,26 +342,58 @@ messages::structure::format(std::any structured_related_images) {
   //<editor-fold desc="Messages">
   // Iterate over the messages, and format them
   std::string formatted_messages;
-  for (auto &message : this->messages) {
-    formatted_messages += message.format();
+  for (std::size_t index = 0; index < store.size(); index++) {
+    store.format(index, this->authors.name(store.author_ids[index]),
+                 compact_markup, formatted_messages);
 
     // Iterate over the images, checking if one matches this message, if so
     // format and add it
     for (auto &image : images.images)
-      if (image.related_message_id == message.id)
-        formatted_messages += image.format();
+      if (image.related_message_id == store.ids[index])
+        formatted_messages += image.format(compact_markup);
   }
 
   template_ready_messages.insert(
-      std::pair<std::string, std::string>("messages", formatted_messages));
+      std::pair<std::string, std::string>("messages",
+                                          std::move(formatted_messages)));
   //</editor-fold>
 
-  std::cout << "..." << messages.size() << " messages formatted." << std::endl;
+  std::cout << "..." << store.size() << " messages formatted." << std::endl;
 
   // Return the formatted messages
   return template_ready_messages;
 }
 
+std::string messages::structure::format_authors() {
+  // Iterate over the messages and find each author, by their id
+  std::vector<int> authors;
+  std::vector<bool> seen(this->authors.size(), false);
+  for (auto author_id : this->messages.author_ids)
+    if (!seen[author_id]) {
+      seen[author_id] = true;
+      authors.push_back(author_id);
+    }
+
+  // Format the authors into a string
+  std::string formatted_authors;
+  // 1 Author
+  if (authors.size() == 1)
+    formatted_authors = this->authors.name(authors.front());
+  // 2 Authors
+  else if (authors.size() == 2)
+    formatted_authors = this->authors.name(authors.front()) + " and " +
+                        this->authors.name(authors.back());
+  // 3+ Authors
+  else {
+    for (auto &author_id : authors)
+      formatted_authors += this->authors.name(author_id) + ", ";
+    formatted_authors =
+        formatted_authors.substr(0, formatted_authors.size() - 2);
+  }
+
+  return formatted_authors;
+}
+
 void messages::structure::set_time_data(
     std::chrono::system_clock::time_point start_time,
     std::chrono::system_clock::time_point end_time) {
@@ -351,12 +413,16 @@ void messages::structure::set_time_data(
 }
 
 void messages::structure::debug_print() {
-  for (auto &message : this->messages)
+  auto &store = this->messages;
+  for (std::size_t index = 0; index < store.size(); index++)
     std::cout << std::endl
-              << message.author << " - " << message.into_session
-              << "(ooc:" << (message.is_ooc ? "true" : "false")
-              << ", has cont:" << (message.is_continued ? "true" : "false")
-              << ", is cont:" << (message.is_continuation ? "true" : "false")
+              << this->authors.name(store.author_ids[index]) << " - "
+              << store.into_session(index)
+              << "(ooc:" << (store.flags[index].is_ooc ? "true" : "false")
+              << ", has cont:"
+              << (store.flags[index].is_continued ? "true" : "false")
+              << ", is cont:"
+              << (store.flags[index].is_continuation ? "true" : "false")
               << ")" << std::endl
-              << message.content.to_print() << std::endl;
+              << store.bodies[index].to_print() << std::endl;
 }
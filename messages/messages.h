@@ -4,15 +4,33 @@
 #ifndef MESSAGES_H
 #define MESSAGES_H
 
-#include "message.h"
+#include "../common/mapped_file.h"
+#include "author_table.h"
+#include "message_store.h"
 #include <any>
 #include <chrono>
 #include <list>
 #include <map>
+#include <memory>
 #include <string>
 
 namespace messages {
 
+// What the views held by messages point into. Shared between copies of a
+// structure, so the views stay valid as long as any copy is around
+struct backing {
+public:
+  // The mapped log file and session cache, which borrowed message bodies view
+  // into
+  std::list<std::shared_ptr<common::mapped_file>> mapped_files;
+
+  // Method to keep a mapped file around for as long as the messages are
+  void keep(const std::shared_ptr<common::mapped_file> &file);
+
+  // Method to stop keeping a mapped file, once nothing views into it
+  void release(const std::shared_ptr<common::mapped_file> &file);
+};
+
 struct structure {
 public:
   // Metadata about the messages
@@ -31,31 +49,47 @@ public:
 
   // Constructor, loads message objects into the array, and sets broad metadata
   structure(std::string owner, int number_of_messages,
-            int number_of_participants, std::list<messages::message> messages,
+            messages::author_table authors,
+            messages::message_store messages,
             std::chrono::system_clock::time_point start_time,
             std::chrono::system_clock::time_point end_time);
   structure() = default;
 
+  // The session is moved from stage to stage and changed in place, never
+  // copied, so only one copy of the messages is alive at a time
+  structure(const structure &) = delete;
+  structure &operator=(const structure &) = delete;
+  structure(structure &&) = default;
+  structure &operator=(structure &&) = default;
+
+  // Method to put the messages in time order, returning how many runs of
+  // messages were out of order
+  int sort_by_time();
+
   // Method to combine continued messages
   int combine(bool debug);
 
-  // Method to remove OOC messages
-  int remove_ooc();
-
   // Method to highlight ~emphatics~
-  int highlight_emphatics(std::string color);
+  int highlight_emphatics();
 
-  // Method to format the messages into HTML
-  std::map<std::string, std::string> format();
+  // Method to format the messages into HTML, with or without spacers
+  std::map<std::string, std::string> format(bool compact_markup);
 
   // Method to format the messages into HTML, with related images
-  std::map<std::string, std::string> format(std::any structured_related_images);
+  std::map<std::string, std::string> format(std::any structured_related_images,
+                                            bool compact_markup);
 
   // Method to format the messages out into a debug print
   void debug_print();
 
-  // Array of messages
-  std::list<messages::message> messages;
+  // The messages, in columns
+  messages::message_store messages;
+
+  // Unique character names, which messages refer to by id
+  messages::author_table authors;
+
+  // What the messages' views point into
+  std::shared_ptr<messages::backing> backing;
 
   // Duration of the messages
   std::chrono::duration<double> elapsed_time;
@@ -65,6 +99,9 @@ private:
   std::chrono::system_clock::time_point start_time;
   std::chrono::system_clock::time_point end_time;
 
+  // Method to format the authors of the messages, in order of appearance
+  std::string format_authors();
+
   // Method to set the time data
   void set_time_data(std::chrono::system_clock::time_point start_time,
                      std::chrono::system_clock::time_point end_time);
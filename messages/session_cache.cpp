@@ -0,0 +1,289 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "session_cache.h"
+#include "../common/binary_file.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+
+namespace messages {
+
+// Marks the start of every snapshot
+const char cache_magic[8] = {'X', 'I', 'V', 'R', 'P', 'S', 'C', '\0'};
+
+// Bumped whenever the snapshot layout, or what is worked out from a message's
+// content, changes; so old snapshots are ignored instead of misread
+const std::uint32_t cache_version = 7;
+
+// How much of the start of the log, and of the end of what was read of it, is
+// hashed to check that it was only added onto since
+const std::size_t checkpoint_window = 4096;
+
+// Bits of the flags saved for each message
+enum cache_flags : std::uint8_t {
+  continued = 1,
+  continuation = 2,
+  emphatics = 4,
+  ooc = 8,
+};
+
+session_cache::session_cache(const std::string &log_file_path) {
+  this->log_file_path = log_file_path;
+  this->cache_file_path = log_file_path + ".cache";
+
+  // Find what the log is like now
+  std::error_code error;
+  this->log_size = std::filesystem::file_size(log_file_path, error);
+  this->log_modified = std::filesystem::last_write_time(log_file_path, error)
+                           .time_since_epoch()
+                           .count();
+}
+
+// Method to add some contents onto a hash; FNV-1a, a word at a time and then
+// the leftover bytes
+static std::uint64_t hash_contents(std::string_view contents,
+                                   std::uint64_t hash = 14695981039346656037ULL) {
+  std::size_t i = 0;
+  for (; i + 8 <= contents.size(); i += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, contents.data() + i, 8);
+    hash = (hash ^ word) * 1099511628211ULL;
+  }
+  for (; i < contents.size(); i++)
+    hash = (hash ^ std::uint8_t(contents[i])) * 1099511628211ULL;
+
+  return hash;
+}
+
+// Where the hash of the log up to an offset is kept up to, so it can be
+// carried on from later; hashes are added onto a word at a time, so they only
+// carry on the same as one hash of the whole log from a word boundary
+static std::uint64_t hashable_until(std::uint64_t until) {
+  return until / 8 * 8;
+}
+
+std::uint64_t session_cache::hash_log() const {
+  common::mapped_file log(this->log_file_path);
+  return hash_contents(log.contents());
+}
+
+std::uint64_t session_cache::hash_checkpoint(std::uint64_t until) const {
+  common::mapped_file log(this->log_file_path);
+  std::string_view contents = log.contents();
+  if (until > contents.size())
+    return 0;
+
+  // The start of the log
+  std::size_t head = std::min<std::size_t>(until, checkpoint_window);
+  std::uint64_t hash = hash_contents(contents.substr(0, head));
+
+  // And the end of what was read of it
+  std::size_t tail = std::min<std::size_t>(until, checkpoint_window);
+  return hash_contents(contents.substr(until - tail, tail), hash);
+}
+
+bool session_cache::load(messages::ingest &ingest, bool follow) {
+  if (!std::filesystem::exists(this->cache_file_path))
+    return false;
+
+  // Map the snapshot, which the restored message bodies will view into
+  auto snapshot = std::make_shared<common::mapped_file>(this->cache_file_path);
+  if (!snapshot->is_open())
+    return false;
+  common::binary_reader reader(snapshot->contents());
+
+  //<editor-fold desc="Header">
+  // Make sure this is a snapshot this version can read
+  auto magic = reader.read_text();
+  if (magic != std::string_view(cache_magic, sizeof(cache_magic)) ||
+      reader.read<std::uint32_t>() != cache_version)
+    return false;
+
+  auto size = reader.read<std::uint64_t>();
+  auto modified = reader.read<std::int64_t>();
+  auto hash = reader.read<std::uint64_t>();
+  auto parsed_until = reader.read<std::uint64_t>();
+  auto parsed_hash = reader.read<std::uint64_t>();
+  auto checkpoint = reader.read<std::uint64_t>();
+  auto filter = reader.read_text();
+  if (reader.failed)
+    return false;
+
+  // Make sure the same records were filtered out as would be now
+  if (filter != ingest.filter->description)
+    return false;
+
+  // Make sure the log is still what the snapshot was made from. If only the
+  // modification time changed, check the contents before giving up
+  bool unchanged = size == this->log_size &&
+                   (modified == this->log_modified || hash == this->hash_log());
+
+  // Or, if following the log, that it was only added onto since
+  bool added_onto = follow && !unchanged && parsed_until > 0 &&
+                    this->log_size > size &&
+                    checkpoint == this->hash_checkpoint(parsed_until);
+
+  if (!unchanged && !added_onto)
+    return false;
+  this->is_partial = added_onto;
+  this->parsed_until = parsed_until;
+  this->parsed_hash = parsed_hash;
+  //</editor-fold>
+
+  //<editor-fold desc="Metadata">
+  ingest.backing->keep(snapshot);
+  ingest.owner = reader.read_text();
+  ingest.number_of_records = reader.read<std::int32_t>();
+  ingest.skipped_messages = reader.read<std::int32_t>();
+  ingest.start_time = reader.read_time();
+  ingest.end_time = reader.read_time();
+
+  // Restore the names, in order so they get back the same ids
+  auto number_of_participants = reader.read<std::uint32_t>();
+  for (std::uint32_t i = 0; i < number_of_participants && !reader.failed; i++)
+    ingest.authors.intern(reader.read_text());
+  //</editor-fold>
+
+  //<editor-fold desc="Messages">
+  auto number_of_messages = reader.read<std::uint32_t>();
+  for (std::uint32_t i = 0; i < number_of_messages && !reader.failed; i++) {
+    auto id = reader.read<std::int32_t>();
+    auto author_id = reader.read<std::uint32_t>();
+    auto time = reader.read_time();
+    auto message_length = reader.read<std::int32_t>();
+    auto cjk_characters = reader.read<std::int32_t>();
+    auto flags = reader.read<std::uint8_t>();
+    auto content = reader.read_text();
+
+    if (reader.failed || author_id >= number_of_participants)
+      return false;
+
+    messages::message_flags message_flags;
+    message_flags.is_continued = flags & cache_flags::continued;
+    message_flags.is_continuation = flags & cache_flags::continuation;
+    message_flags.has_emphatics = flags & cache_flags::emphatics;
+    message_flags.is_ooc = flags & cache_flags::ooc;
+
+    ingest.messages.add(id, int(author_id),
+                        messages::message_body::borrow(content),
+                        ingest.start_time, time, message_length,
+                        cjk_characters, message_flags);
+  }
+  //</editor-fold>
+
+  if (reader.failed)
+    return false;
+  this->snapshot = snapshot;
+  return true;
+}
+
+void session_cache::release_snapshot(messages::ingest &ingest) {
+  if (this->snapshot == nullptr)
+    return;
+
+  // Only the bodies viewing into the snapshot need copying, not those viewing
+  // into the log
+  auto contents = this->snapshot->contents();
+  std::less<const char *> before;
+  for (auto &body : ingest.messages.bodies) {
+    const char *text = body.text().data();
+    if (!before(text, contents.data()) &&
+        before(text, contents.data() + contents.size()))
+      body.own();
+  }
+
+  ingest.backing->release(this->snapshot);
+  this->snapshot = nullptr;
+}
+
+void session_cache::save(messages::ingest &ingest,
+                         std::uint64_t parsed_until) {
+  // The snapshot can't be replaced while it's still mapped
+  this->release_snapshot(ingest);
+
+  //<editor-fold desc="Hashing">
+  common::mapped_file log(this->log_file_path);
+  std::string_view contents = log.contents();
+  parsed_until = std::min<std::uint64_t>(parsed_until, contents.size());
+
+  // Hash the log up to where its records end, carrying on from the restored
+  // snapshot's hash if the log was only added onto since, so only what was
+  // added is hashed
+  std::uint64_t hashed_until = 0;
+  std::uint64_t parsed_hash = hash_contents({});
+  if (this->is_partial && this->parsed_until <= parsed_until) {
+    hashed_until = hashable_until(this->parsed_until);
+    parsed_hash = this->parsed_hash;
+  }
+  std::uint64_t parsed_hashable_until = hashable_until(parsed_until);
+  parsed_hash = hash_contents(
+      contents.substr(hashed_until, parsed_hashable_until - hashed_until),
+      parsed_hash);
+
+  // Then the rest of the log, for the hash of the whole log
+  std::uint64_t log_hash =
+      hash_contents(contents.substr(parsed_hashable_until), parsed_hash);
+  //</editor-fold>
+
+  common::binary_writer writer;
+
+  //<editor-fold desc="Header">
+  writer.write_text(std::string_view(cache_magic, sizeof(cache_magic)));
+  writer.write(cache_version);
+  writer.write(this->log_size);
+  writer.write(this->log_modified);
+  writer.write(log_hash);
+  writer.write(parsed_until);
+  writer.write(parsed_hash);
+  writer.write(parsed_until > 0 ? this->hash_checkpoint(parsed_until) : 0);
+  writer.write_text(ingest.filter->description);
+  //</editor-fold>
+
+  //<editor-fold desc="Metadata">
+  writer.write_text(ingest.owner);
+  writer.write(std::int32_t(ingest.number_of_records));
+  writer.write(std::int32_t(ingest.skipped_messages));
+  writer.write_time(ingest.start_time);
+  writer.write_time(ingest.end_time);
+
+  // Save the names, in order of their ids
+  writer.write(std::uint32_t(ingest.authors.size()));
+  for (int author_id = 0; author_id < ingest.authors.size(); author_id++)
+    writer.write_text(ingest.authors.name(author_id));
+  //</editor-fold>
+
+  //<editor-fold desc="Messages">
+  const auto &store = ingest.messages;
+  writer.write(std::uint32_t(store.size()));
+  for (std::size_t index = 0; index < store.size(); index++) {
+    const auto &message_flags = store.flags[index];
+    std::uint8_t flags = 0;
+    if (message_flags.is_continued)
+      flags |= cache_flags::continued;
+    if (message_flags.is_continuation)
+      flags |= cache_flags::continuation;
+    if (message_flags.has_emphatics)
+      flags |= cache_flags::emphatics;
+    if (message_flags.is_ooc)
+      flags |= cache_flags::ooc;
+
+    writer.write(std::int32_t(store.ids[index]));
+    writer.write(std::uint32_t(store.author_ids[index]));
+    writer.write_time(store.times[index]);
+    writer.write(std::int32_t(store.message_lengths[index]));
+    writer.write(std::int32_t(store.cjk_characters[index]));
+    writer.write(flags);
+    writer.write_text(store.bodies[index].text());
+  }
+  //</editor-fold>
+
+  if (writer.save(this->cache_file_path))
+    std::cout << "...session cache saved" << std::endl;
+  else
+    std::cout << "...could not save the session cache" << std::endl;
+}
+
+} // namespace messages
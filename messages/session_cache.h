@@ -0,0 +1,73 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_SESSION_CACHE_H
+#define XIVRP_FORMATTER_SESSION_CACHE_H
+
+#include "../common/mapped_file.h"
+#include "ingest.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace messages {
+
+// A binary snapshot of a loaded log, saved next to the log so later runs can
+// skip parsing it for as long as the log doesn't change
+class session_cache {
+public:
+  // Constructor, finds the snapshot for the given log and what the log is like
+  // now, to check the snapshot against
+  explicit session_cache(const std::string &log_file_path);
+
+  // Method to restore a loaded log from its snapshot, false if there is no
+  // snapshot, the log has changed since it was saved, or it was saved with a
+  // different filter. If following the log,
+  // a snapshot from before the log was added onto is restored too, and marked
+  // as partial
+  bool load(messages::ingest &ingest, bool follow);
+
+  // Method to save a loaded log to its snapshot, with how far into the log its
+  // records went, for following the log; 0 if that isn't known. Messages
+  // restored from the old snapshot are copied out of it first, so it can be
+  // replaced
+  void save(messages::ingest &ingest, std::uint64_t parsed_until);
+
+  // Whether the restored snapshot only covers the start of the log, which was
+  // added onto after the snapshot was saved
+  bool is_partial{false};
+
+  // How far into the log the restored snapshot's records went
+  std::uint64_t parsed_until{0};
+
+  // Hash of the log up to the word boundary before that, to carry on hashing
+  // what was added onto the log from
+  std::uint64_t parsed_hash{0};
+
+private:
+  // Paths to the log and its snapshot
+  std::string log_file_path;
+  std::string cache_file_path;
+
+  // Size and modification time of the log
+  std::uint64_t log_size{0};
+  std::int64_t log_modified{0};
+
+  // The restored snapshot, which restored message bodies view into
+  std::shared_ptr<common::mapped_file> snapshot;
+
+  // Method to copy the restored message bodies out of the snapshot, and stop
+  // mapping it
+  void release_snapshot(messages::ingest &ingest);
+
+  // Method to hash the contents of the log
+  [[nodiscard]] std::uint64_t hash_log() const;
+
+  // Method to hash the start of the log, and the end of what was read of it,
+  // to check that the log was only added onto since
+  [[nodiscard]] std::uint64_t hash_checkpoint(std::uint64_t until) const;
+};
+
+} // namespace messages
+
+#endif // XIVRP_FORMATTER_SESSION_CACHE_H
@@ -0,0 +1,163 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#include "time_index.h"
+#include "../common/binary_file.h"
+#include "../common/mapped_file.h"
+#include "../common/utilities.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+namespace messages {
+
+// Marks the start of every index
+const char index_magic[8] = {'X', 'I', 'V', 'R', 'P', 'T', 'I', '\0'};
+
+// Bumped whenever the index layout changes
+const std::uint32_t index_version = 2;
+
+time_index::time_index(messages::log_file &log,
+                       const std::string &log_file_path) {
+  this->index_file_path = log_file_path + ".index";
+
+  // Find what the log is like now
+  std::error_code error;
+  this->log_size = std::filesystem::file_size(log_file_path, error);
+  this->log_modified = std::filesystem::last_write_time(log_file_path, error)
+                           .time_since_epoch()
+                           .count();
+
+  // Use the saved index, or build it the first time it's needed, which needs
+  // the whole log scanned for its records
+  if (this->load(log))
+    return;
+  if (!log.is_scanned && !log.find_records())
+    return;
+
+  std::cout << "...building the log's time index" << std::endl;
+  this->build(log);
+  this->save();
+}
+
+std::pair<std::size_t, std::size_t>
+time_index::find_range(std::chrono::system_clock::time_point start,
+                       std::chrono::system_clock::time_point end) const {
+  // Binary search for the range, if the records are in order
+  if (this->is_sorted) {
+    auto first = std::lower_bound(
+        this->entries.begin(), this->entries.end(), start,
+        [](const time_index_entry &entry,
+           std::chrono::system_clock::time_point time) {
+          return entry.time < time;
+        });
+    auto last = std::upper_bound(
+        first, this->entries.end(), end,
+        [](std::chrono::system_clock::time_point time,
+           const time_index_entry &entry) { return time < entry.time; });
+
+    return {first - this->entries.begin(), last - this->entries.begin()};
+  }
+
+  // Otherwise, from the first record in the range to the last
+  std::size_t first = this->entries.size();
+  std::size_t last = 0;
+  for (std::size_t i = 0; i < this->entries.size(); i++)
+    if (this->entries[i].time >= start && this->entries[i].time <= end) {
+      first = std::min(first, i);
+      last = i + 1;
+    }
+
+  if (first >= last)
+    return {0, 0};
+
+  return {first, last};
+}
+
+bool time_index::load(messages::log_file &log) {
+  if (!std::filesystem::exists(this->index_file_path))
+    return false;
+
+  common::mapped_file file(this->index_file_path);
+  if (!file.is_open())
+    return false;
+  common::binary_reader reader(file.contents());
+
+  // Make sure this is an index this version can read, of the log as it is now
+  auto magic = reader.read_text();
+  if (magic != std::string_view(index_magic, sizeof(index_magic)) ||
+      reader.read<std::uint32_t>() != index_version ||
+      reader.read<std::uint64_t>() != this->log_size ||
+      reader.read<std::int64_t>() != this->log_modified)
+    return false;
+
+  // And, if the log was already scanned, that it has the same records
+  auto number_of_entries = reader.read<std::uint64_t>();
+  if (reader.failed ||
+      (log.is_scanned && number_of_entries != log.records.size()))
+    return false;
+
+  this->is_sorted = reader.read<std::uint8_t>() != 0;
+  this->entries.reserve(number_of_entries);
+  for (std::uint64_t i = 0; i < number_of_entries && !reader.failed; i++) {
+    auto start = reader.read<std::uint64_t>();
+    auto end = reader.read<std::uint64_t>();
+    this->entries.push_back({start, end, reader.read_time()});
+  }
+
+  if (reader.failed ||
+      (log.is_scanned && !this->entries.empty() &&
+       this->entries.back().start != log.records.back().first)) {
+    this->entries.clear();
+    return false;
+  }
+
+  // Otherwise the log's records are where the index says they are
+  if (!log.is_scanned) {
+    log.records.reserve(this->entries.size());
+    for (const auto &entry : this->entries)
+      log.records.emplace_back(entry.start, entry.end);
+  }
+
+  return true;
+}
+
+void time_index::build(const messages::log_file &log) {
+  this->entries.reserve(log.records.size());
+
+  // Read just when each record was sent
+  for (std::size_t i = 0; i < log.records.size(); i++) {
+    messages::raw_record fields;
+    log.read_record(i, fields);
+
+    auto time = common::utilities::convert_timestamp(
+        raw_record::unescape(fields.date_sent));
+    if (!this->entries.empty() && time < this->entries.back().time)
+      this->is_sorted = false;
+
+    this->entries.push_back(
+        {log.records[i].first, log.records[i].second, time});
+  }
+}
+
+void time_index::save() const {
+  common::binary_writer writer;
+
+  writer.write_text(std::string_view(index_magic, sizeof(index_magic)));
+  writer.write(index_version);
+  writer.write(this->log_size);
+  writer.write(this->log_modified);
+  writer.write(std::uint64_t(this->entries.size()));
+  writer.write(std::uint8_t(this->is_sorted));
+
+  for (const auto &entry : this->entries) {
+    writer.write(entry.start);
+    writer.write(entry.end);
+    writer.write_time(entry.time);
+  }
+
+  if (!writer.save(this->index_file_path))
+    std::cout << "...could not save the log's time index" << std::endl;
+}
+
+} // namespace messages
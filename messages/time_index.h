@@ -0,0 +1,66 @@
+// XIVRP-Formatter Copyright (C) 2024 Ethan Henderson <ethan@zbee.codes>
+// Licensed under GPLv3 - Refer to the LICENSE file for the complete text
+
+#ifndef XIVRP_FORMATTER_TIME_INDEX_H
+#define XIVRP_FORMATTER_TIME_INDEX_H
+
+#include "log_file.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace messages {
+
+// Where a record is in the log, and when it was sent
+struct time_index_entry {
+public:
+  std::uint64_t start;
+  std::uint64_t end;
+  std::chrono::system_clock::time_point time;
+};
+
+// A sidecar index of where each record in the log is and when it was sent,
+// saved next to the log so a time range can be found, and its records read,
+// without scanning the whole log
+class time_index {
+public:
+  // Constructor, loads the index for the log and gives the log its records
+  // from it; or if there isn't one that's up to date, scans the log for its
+  // records, and builds and saves the index from them
+  time_index(messages::log_file &log, const std::string &log_file_path);
+
+  // One entry per record in the log, in the log's order
+  std::vector<messages::time_index_entry> entries;
+
+  // Method to find the first and one-past-last records sent within the times
+  [[nodiscard]] std::pair<std::size_t, std::size_t>
+  find_range(std::chrono::system_clock::time_point start,
+             std::chrono::system_clock::time_point end) const;
+
+private:
+  // Path to the index
+  std::string index_file_path;
+
+  // Size and modification time of the log
+  std::uint64_t log_size{0};
+  std::int64_t log_modified{0};
+
+  // Whether the records are in time order, so the range can be searched for
+  bool is_sorted{true};
+
+  // Method to load the index, false if it's missing or out of date
+  bool load(messages::log_file &log);
+
+  // Method to build the index from the log's records
+  void build(const messages::log_file &log);
+
+  // Method to save the index
+  void save() const;
+};
+
+} // namespace messages
+
+#endif // XIVRP_FORMATTER_TIME_INDEX_H
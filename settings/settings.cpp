@@ -2,6 +2,7 @@
 // Licensed under GPLv3 - Refer to the LICENSE file for the complete text
 
 #include "settings.h"
+#include "../common/decompressing_buffer.h"
 #include "../common/utilities.h"
 #include <filesystem>
 #include <fstream>
@@ -83,29 +84,70 @@ std::tuple<bool, json> settings::loader::check_arguments(int arg_count,
 }
 
 /**
- * @brief Checks if the log file is valid
+ * @brief Checks if the log file is valid, with a structural scan of the mapped
+ * file instead of a full parse, keeping the result for loading. The log is
+ * only checked to start like a log here, since its records aren't needed if
+ * it's restored from its session cache or time index; they're found when it
+ * is loaded. Compressed logs are only checked to start like a log once
+ * decompressed
  * @return Whether the log file is valid
  * @todo Switch to using log_sources verification
  */
-bool settings::loader::verify_log_file() const {
+bool settings::loader::verify_log_file() {
   // Double check that the log file exists
   if (!common::utilities::check_file_exists(this->settings.log_file_path))
     return false;
+
+  // Compressed logs can't be mapped, so just check they can be decompressed
+  auto compression = common::decompressing_buffer::compression_for(
+      this->settings.log_file_path);
+  if (compression != common::compression::none)
+    return this->verify_compressed_log_file(compression);
   // Double check that the log file is json
   if (!common::utilities::check_file_format(this->settings.log_file_path,
                                             ".json"))
     return false;
 
-  try {
-    // Try to load the message log file, and parse it as json
-    std::ifstream log_file(this->settings.log_file_path);
-    json log_json = json::parse(log_file);
-    // Return true if the log file was parsed
-    return true;
-  } catch (json::parse_error &e) {
-    // If the log file is not valid json, return false
+  // Map the log file and check it opens an array; its records are found, and
+  // checked, as they are loaded
+  this->log_file =
+      std::make_shared<messages::log_file>(this->settings.log_file_path, false);
+
+  // Return true if the log file was shaped like a log
+  return this->log_file->is_valid;
+}
+
+/**
+ * @brief Checks if a compressed log file can be decompressed by this build,
+ * and that it starts like a log once it is
+ * @param compression How the log file is compressed
+ * @return Whether the log file is valid
+ */
+bool settings::loader::verify_compressed_log_file(
+    common::compression compression) {
+  if (!common::decompressing_buffer::is_supported(compression)) {
+    std::cout << "Error: This build can't decompress "
+              << std::filesystem::path(this->settings.log_file_path)
+                     .extension()
+                     .string()
+              << " log files." << std::endl;
     return false;
   }
+
+  common::decompressing_buffer buffer(this->settings.log_file_path,
+                                      compression);
+  std::istream stream(&buffer);
+
+  // Find the first character, past any byte order mark
+  char first = 0;
+  stream >> first;
+  if (first == '\xEF') {
+    stream.ignore(2);
+    stream >> first;
+  }
+
+  // Return true if the log file starts with an array, like a log
+  return buffer.is_open() && first == '[';
 }
 
 /**
@@ -247,8 +289,9 @@ bool settings::structure::set_setting(const std::string &setting,
   // Save basic casts
   auto const string_value = std::any_cast<std::string>(value);
   bool bool_value = string_value == "yes";
+  bool is_number = std::isdigit(static_cast<unsigned char>(string_value[0]));
   int int_value;
-  if (std::isdigit(string_value[0]))
+  if (is_number)
     int_value = std::stoi(string_value);
 
   // Save the setting to the working json and map
@@ -264,18 +307,39 @@ bool settings::structure::set_setting(const std::string &setting,
   else if (setting == "log_file_type") {
     auto save_value = static_cast<log_type>(int_value);
     this->log_file_type = save_value;
-  } else if (setting == "template_file_path")
+  } else if (setting == "follow_log")
+    this->follow_log = bool_value;
+  else if (setting == "limit_time_range")
+    this->limit_time_range = bool_value;
+  else if (setting == "time_range_start")
+    this->time_range_start = string_value;
+  else if (setting == "time_range_end")
+    this->time_range_end = string_value;
+  else if (setting == "template_file_path")
     this->template_file_path = string_value;
   else if (setting == "output_file_path")
     this->output_file_path = string_value;
   else if (setting == "remove_out_of_character")
     this->remove_out_of_character = bool_value;
-  else if (setting == "highlight_emphatics")
+  else if (setting == "out_of_character_marks")
+    this->out_of_character_marks = string_value;
+  else if (setting == "include_authors")
+    this->include_authors = string_value;
+  else if (setting == "exclude_authors")
+    this->exclude_authors = string_value;
+  else if (setting == "minimum_message_length") {
+    if (is_number)
+      this->minimum_message_length = int_value;
+  } else if (setting == "highlight_emphatics")
     this->highlight_emphatics = bool_value;
   else if (setting == "emphatic_highlight_color")
     this->emphatic_highlight_color = string_value;
   else if (setting == "combine_messages")
     this->combine_messages = bool_value;
+  else if (setting == "continued_marks")
+    this->continued_marks = string_value;
+  else if (setting == "continuation_marks")
+    this->continuation_marks = string_value;
   else if (setting == "combine_logs")
     this->combine_logs = bool_value;
   else if (setting == "find_related_images")
@@ -287,6 +351,8 @@ bool settings::structure::set_setting(const std::string &setting,
     this->want_timestamps = bool_value;
   else if (setting == "squash_time_gaps")
     this->squash_time_gaps = bool_value;
+  else if (setting == "compact_markup")
+    this->compact_markup = bool_value;
   else if (setting == "debug")
     this->debug = bool_value;
   else
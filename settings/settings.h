@@ -4,9 +4,12 @@
 #ifndef SETTINGS_H
 #define SETTINGS_H
 
+#include "../common/decompressing_buffer.h"
 #include "../common/utilities.h"
 #include "../includes/json.hpp"
+#include "../messages/log_file.h"
 #include "ask.h"
+#include <memory>
 #include <string>
 
 using json = nlohmann::json;
@@ -66,6 +69,30 @@ struct structure {
    * @see settings::structure::log_file_path
    */
   log_type log_file_type{log_type::smartFind};
+  /**
+   * @brief Whether the log is still being added to, so only what was added
+   * since the last run needs to be read
+   * @see messages::session_cache
+   */
+  bool follow_log{false};
+  /**
+   * @brief Whether only the messages sent within a time range should be read
+   * @see settings::structure::time_range_start
+   * @see settings::structure::time_range_end
+   */
+  bool limit_time_range{false};
+  /**
+   * @brief When the time range starts, e.g. 2024-03-01T20:00:00-05:00, or
+   * blank for the start of the log
+   * @see messages::time_index
+   */
+  std::string time_range_start;
+  /**
+   * @brief When the time range ends, e.g. 2024-03-01T23:00:00-05:00, or blank
+   * for the end of the log
+   * @see messages::time_index
+   */
+  std::string time_range_end;
   /**
    * @brief The path to the template file
    */
@@ -77,8 +104,31 @@ struct structure {
 
   /**
    * @brief Whether out of character messages should be removed
+   * @see messages::filter
    */
   bool remove_out_of_character{true};
+  /**
+   * @brief Marks at the start of a message that make it out of character,
+   * separated by spaces, or blank for the usual ones
+   * @see messages::markers
+   */
+  std::string out_of_character_marks;
+  /**
+   * @brief The only characters whose messages should be kept, separated by
+   * commas, or blank for everyone
+   * @see messages::filter
+   */
+  std::string include_authors;
+  /**
+   * @brief Characters whose messages should be removed, separated by commas
+   * @see messages::filter
+   */
+  std::string exclude_authors;
+  /**
+   * @brief How many characters long a message has to be to be kept
+   * @see messages::filter
+   */
+  int minimum_message_length{10};
 
   /**
    * @brief Whether emphatics should be highlighted
@@ -95,6 +145,18 @@ struct structure {
    * @brief Whether messages that are continuations of others should be combined
    */
   bool combine_messages{true};
+  /**
+   * @brief Marks at the end of a message that mean it is continued in the next
+   * one, separated by spaces, or blank for the usual ones
+   * @see messages::markers
+   */
+  std::string continued_marks;
+  /**
+   * @brief Marks at the start of a message that mean it continues the one
+   * before it, separated by spaces, or blank for the usual ones
+   * @see messages::markers
+   */
+  std::string continuation_marks;
 
   /**
    * @brief Whether multiple logs should be combined and de-duplicated (from all
@@ -121,6 +183,11 @@ struct structure {
    * @brief Whether gaps in timestamps should be filled
    */
   bool squash_time_gaps{true};
+  /**
+   * @brief Whether the output should leave out the spacer elements around each
+   * message, with the template laying out its grid without them
+   */
+  bool compact_markup{true};
 
   /**
    * @brief Whether the program should print debug information
@@ -144,18 +211,29 @@ struct structure {
   std::map<std::string, std::string> settings = {
       {"log_file_path", log_file_path},
       {"log_file_type", std::to_string(log_file_type)},
+      {"follow_log", follow_log ? "yes" : "no"},
+      {"limit_time_range", limit_time_range ? "yes" : "no"},
+      {"time_range_start", time_range_start},
+      {"time_range_end", time_range_end},
       {"template_file_path",
        common::utilities::get_real_path(template_file_path)},
       {"output_file_path", output_file_path},
       {"remove_out_of_character", remove_out_of_character ? "yes" : "no"},
+      {"out_of_character_marks", out_of_character_marks},
+      {"include_authors", include_authors},
+      {"exclude_authors", exclude_authors},
+      {"minimum_message_length", std::to_string(minimum_message_length)},
       {"highlight_emphatics", highlight_emphatics ? "yes" : "no"},
       {"emphatic_highlight_color", emphatic_highlight_color},
       {"combine_messages", combine_messages ? "yes" : "no"},
+      {"continued_marks", continued_marks},
+      {"continuation_marks", continuation_marks},
       {"combine_logs", combine_logs ? "yes" : "no"},
       {"find_related_images", find_related_images ? "yes" : "no"},
       {"related_images_location", std::to_string(related_images_location)},
       {"want_timestamps", want_timestamps ? "yes" : "no"},
       {"squash_time_gaps", squash_time_gaps ? "yes" : "no"},
+      {"compact_markup", compact_markup ? "yes" : "no"},
       {"debug", debug ? "yes" : "no"},
   };
   //</editor-fold>
@@ -259,6 +337,42 @@ struct structure {
             },
         }}},
       //</editor-fold>
+      {{"identifier", "follow_log"},
+       {"question", "Is the log still being added to, so only new messages "
+                    "need to be read?"},
+       {"wants", answer_types::yesno}},
+      {{"identifier", "limit_time_range"},
+       {"question", "Should only messages from a certain time be read?"},
+       {"wants", answer_types::yesno}},
+      //<editor-fold desc="time_range_start">
+      {{"identifier", "time_range_start"},
+       {"question", "When should the messages start? (e.g. "
+                    "2024-03-01T20:00:00-05:00, blank for the start of the "
+                    "log)"},
+       {"wants", answer_types::string},
+       {"requires",
+        {
+            {
+                {"identifier", "limit_time_range"},
+                {"comparison", compare::is},
+                {"value", answer::yes},
+            },
+        }}},
+      //</editor-fold>
+      //<editor-fold desc="time_range_end">
+      {{"identifier", "time_range_end"},
+       {"question", "When should the messages end? (e.g. "
+                    "2024-03-01T23:00:00-05:00, blank for the end of the log)"},
+       {"wants", answer_types::string},
+       {"requires",
+        {
+            {
+                {"identifier", "limit_time_range"},
+                {"comparison", compare::is},
+                {"value", answer::yes},
+            },
+        }}},
+      //</editor-fold>
       {{"identifier", "template_file_path"},
        {"question", "Where is the template file you would like to use?"},
        {"wants", answer_types::path}},
@@ -268,6 +382,32 @@ struct structure {
       {{"identifier", "remove_out_of_character"},
        {"question", "Should out of character messages be removed?"},
        {"wants", answer_types::yesno}},
+      //<editor-fold desc="out_of_character_marks">
+      {{"identifier", "out_of_character_marks"},
+       {"question", "What marks start out of character messages? (separated "
+                    "by spaces, blank for the usual ones)"},
+       {"wants", answer_types::string},
+       {"requires",
+        {
+            {
+                {"identifier", "remove_out_of_character"},
+                {"comparison", compare::is},
+                {"value", answer::yes},
+            },
+        }}},
+      //</editor-fold>
+      {{"identifier", "include_authors"},
+       {"question", "Whose messages should be kept? (names separated by "
+                    "commas, blank for everyone)"},
+       {"wants", answer_types::string}},
+      {{"identifier", "exclude_authors"},
+       {"question", "Whose messages should be removed? (names separated by "
+                    "commas, blank for no one)"},
+       {"wants", answer_types::string}},
+      {{"identifier", "minimum_message_length"},
+       {"question", "How many characters long does a message need to be to "
+                    "be kept?"},
+       {"wants", answer_types::string}},
       {{"identifier", "highlight_emphatics"},
        {"question", "Should emphatics be highlighted?"},
        {"wants", answer_types::yesno}},
@@ -288,6 +428,34 @@ struct structure {
        {"question",
         "Should messages that are continuations of others be combined?"},
        {"wants", answer_types::yesno}},
+      //<editor-fold desc="continued_marks">
+      {{"identifier", "continued_marks"},
+       {"question", "What marks end messages that are continued in the next "
+                    "one? (separated by spaces, blank for the usual ones)"},
+       {"wants", answer_types::string},
+       {"requires",
+        {
+            {
+                {"identifier", "combine_messages"},
+                {"comparison", compare::is},
+                {"value", answer::yes},
+            },
+        }}},
+      //</editor-fold>
+      //<editor-fold desc="continuation_marks">
+      {{"identifier", "continuation_marks"},
+       {"question", "What marks start messages that continue the one before "
+                    "them? (separated by spaces, blank for the usual ones)"},
+       {"wants", answer_types::string},
+       {"requires",
+        {
+            {
+                {"identifier", "combine_messages"},
+                {"comparison", compare::is},
+                {"value", answer::yes},
+            },
+        }}},
+      //</editor-fold>
       {{"identifier", "combine_logs"},
        {"question", "Should multiple logs be combined and de-duplicated?"},
        {"wants", answer_types::yesno}},
@@ -337,6 +505,10 @@ struct structure {
       {{"identifier", "squash_time_gaps"},
        {"question", "Should gaps in timestamps be filled?"},
        {"wants", answer_types::yesno}},
+      {{"identifier", "compact_markup"},
+       {"question", "Should the output leave out the spacers around messages? "
+                    "(the template has to lay out its grid without them)"},
+       {"wants", answer_types::yesno}},
       {{"identifier", "debug"}, {"wants", answer_types::yesno}},
   };
   //</editor-fold>
@@ -356,6 +528,13 @@ public:
    * @brief Whether the template file was verified
    */
   [[maybe_unused]] bool template_verified{false};
+  /**
+   * @brief The log file, as mapped during verification, so it can be handed
+   * to messages::load instead of being mapped all over again. Its records are
+   * only found once they're needed, see messages::load
+   * @see settings::loader::verify_log_file()
+   */
+  std::shared_ptr<messages::log_file> log_file;
 
   /**
    * @brief Constructor, to load settings from all sources and verify them
@@ -387,11 +566,23 @@ private:
   get_settings(const json &settings_from_arguments);
 
   /**
-   * @brief Checks if the log file is valid
+   * @brief Checks if the log file is valid, with a structural scan of the
+   * mapped file instead of a full parse, keeping the result for loading
    * @return Whether the log file is valid
+   * @see settings::loader::log_file
    * @todo Switch to using log_sources verification
    */
-  [[nodiscard]] bool verify_log_file() const;
+  [[nodiscard]] bool verify_log_file();
+
+  /**
+   * @brief Checks if a compressed log file can be decompressed by this build,
+   * and that it starts like a log once it is
+   * @param compression How the log file is compressed
+   * @return Whether the log file is valid
+   * @see settings::loader::verify_log_file()
+   */
+  [[nodiscard]] bool
+  verify_compressed_log_file(common::compression compression);
 
   /**
    * @brief Checks if the template file is valid
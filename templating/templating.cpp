@@ -50,7 +50,9 @@ void templating::templator::fill_template(const std::string &output_file) {
     exit(6);
   }
 
-  // Fill all the tags in the template file
+  // Fill all the tags in the template file, starting with the styles, before
+  // any messages could be mistaken for the styles tag
+  this->fill_styles(content[STYLES_DATA]);
   this->fill_tag(AUTHORS_TAG, content[AUTHORS_DATA]);
   this->fill_tag(AUTHORS_TAG, content[AUTHORS_DATA]);
   this->fill_tag(METADATA_TAG, content[METADATA_DATA]);
@@ -82,3 +84,19 @@ void templating::templator::fill_tag(const std::string &tag,
   // Replace the tag with the content
   this->output_file_contents.replace(tag_location, tag.length(), content);
 }
+
+void templating::templator::fill_styles(const std::string &styles) {
+  // Fill the output file contents with the template file contents the first
+  // time
+  if (this->output_file_contents.empty()) {
+    this->output_file_contents = this->template_file_contents;
+  }
+
+  // Templates from before the styles tag get the styles at the end of their
+  // head instead
+  if (this->output_file_contents.find(STYLES_TAG) != std::string::npos)
+    this->fill_tag(STYLES_TAG, styles);
+  else if (std::size_t head_end = this->output_file_contents.find("</head>");
+           head_end != std::string::npos)
+    this->output_file_contents.insert(head_end, styles);
+}
@@ -12,10 +12,12 @@ namespace templating {
 std::string const AUTHORS_TAG = "{{ authors }}";
 std::string const METADATA_TAG = "{{ metadata }}";
 std::string const MESSAGES_TAG = "{{ messages }}";
+std::string const STYLES_TAG = "{{ styles }}";
 
 std::string const AUTHORS_DATA = "authors";
 std::string const METADATA_DATA = "metadata";
 std::string const MESSAGES_DATA = "messages";
+std::string const STYLES_DATA = "styles";
 
 class templator {
 public:
@@ -30,6 +32,8 @@ private:
   std::string output_file_contents;
 
   void fill_tag(const std::string &tag, const std::string &content);
+
+  void fill_styles(const std::string &styles);
 };
 
 } // namespace templating